@@ -0,0 +1,140 @@
+// Email: razcohenp@gmail.com
+#ifndef MONOTONICARENA_HPP
+#define MONOTONICARENA_HPP
+
+#include <cstddef> // For std::size_t and std::max_align_t
+#include <memory> // For std::align
+#include <new> // For ::operator new and std::bad_alloc
+#include <algorithm> // For std::max
+
+namespace my_container {
+    // Monotonic memory arena - hands out memory from large blocks and frees it all at once
+    // Individual deallocations are no-ops, so tearing down everything allocated from it costs one free per block
+    class MonotonicArena {
+        private:
+            // Header at the start of every block (blocks form a singly linked list)
+            struct Block {
+                Block* next; // Previously allocated block
+            };
+
+            Block* head; // Most recently allocated block
+            char* cursor; // Next free byte in the current block
+            char* limit; // End of the current block
+            size_t block_size; // Default size of a new block
+            size_t bytes_used; // Total bytes handed out (including alignment padding)
+
+            // Allocate a new block that can hold at least `bytes` with the given alignment
+            void grow(size_t bytes, size_t alignment) {
+                size_t size = std::max(block_size, sizeof(Block) + bytes + alignment);
+                Block* block = static_cast<Block*>(::operator new(size));
+                block->next = head;
+                head = block;
+                cursor = reinterpret_cast<char*>(block) + sizeof(Block);
+                limit = reinterpret_cast<char*>(block) + size;
+            }
+
+        public:
+            // Constructor - no memory is requested until the first allocation
+            explicit MonotonicArena(size_t block_size = 64 * 1024)
+                : head(nullptr), cursor(nullptr), limit(nullptr), block_size(block_size), bytes_used(0) {}
+
+            // The arena owns its blocks, so it can be neither copied nor moved
+            MonotonicArena(const MonotonicArena&) = delete;
+            MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+            // Destructor - frees all blocks
+            ~MonotonicArena() {
+                release();
+            }
+
+            // Return `bytes` of memory aligned to `alignment`
+            void* allocate(size_t bytes, size_t alignment) {
+                size_t space = static_cast<size_t>(limit - cursor); // Free bytes left in the current block
+                void* ptr = cursor;
+
+                // Start a new block if the request does not fit in the current one
+                if (cursor == nullptr || std::align(alignment, bytes, ptr, space) == nullptr) {
+                    grow(bytes, alignment);
+                    space = static_cast<size_t>(limit - cursor);
+                    ptr = cursor;
+                    std::align(alignment, bytes, ptr, space); // Always fits in a fresh block
+                }
+
+                char* end = static_cast<char*>(ptr) + bytes;
+                bytes_used += static_cast<size_t>(end - cursor);
+                cursor = end;
+                return ptr;
+            }
+
+            // Free all blocks at once (everything allocated from the arena becomes invalid)
+            void release() {
+                while (head != nullptr) {
+                    Block* next = head->next;
+                    ::operator delete(head);
+                    head = next;
+                }
+                cursor = nullptr;
+                limit = nullptr;
+                bytes_used = 0;
+            }
+
+            // Return total bytes handed out since construction or the last release
+            size_t bytes_allocated() const {
+                return bytes_used;
+            }
+    };
+
+    // Standard allocator drawing from a MonotonicArena (deallocate is a no-op)
+    // A default-constructed allocator has no arena and falls back to the global heap
+    template <typename T>
+    class ArenaAllocator {
+        private:
+            MonotonicArena* arena_ptr; // Arena to allocate from (nullptr = global heap)
+
+            template <typename U>
+            friend class ArenaAllocator; // To allow rebinding constructors to read arena_ptr
+
+        public:
+            using value_type = T;
+
+            // Constructors
+            ArenaAllocator() noexcept : arena_ptr(nullptr) {}
+            ArenaAllocator(MonotonicArena& arena) noexcept : arena_ptr(&arena) {}
+
+            // Rebinding constructor - allocators of different types share the arena
+            template <typename U>
+            ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_ptr(other.arena_ptr) {}
+
+            // Allocate storage for n objects of type T
+            T* allocate(size_t n) {
+                if (arena_ptr == nullptr) {
+                    return static_cast<T*>(::operator new(n * sizeof(T)));
+                }
+                return static_cast<T*>(arena_ptr->allocate(n * sizeof(T), alignof(T)));
+            }
+
+            // Arena memory is only freed by the arena itself
+            void deallocate(T* ptr, size_t) noexcept {
+                if (arena_ptr == nullptr) {
+                    ::operator delete(ptr);
+                }
+            }
+
+            // Return the arena of this allocator
+            MonotonicArena* arena() const noexcept {
+                return arena_ptr;
+            }
+
+            // Allocators are equal when they draw from the same arena
+            template <typename U>
+            bool operator==(const ArenaAllocator<U>& other) const noexcept {
+                return arena_ptr == other.arena_ptr;
+            }
+
+            template <typename U>
+            bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+                return arena_ptr != other.arena_ptr;
+            }
+    };
+} // namespace my_container
+#endif
@@ -6,14 +6,1030 @@
 #include <algorithm>
 #include <stdexcept>
 #include <iostream>
+#include <memory> // For std::shared_ptr (shared sorted permutation)
 #include <numeric> // For std::iota (to fill a vector with sequential numbers)
+#include <functional> // For std::hash
+#include <iterator> // For std::begin, std::end and iterator tags
+#include <cstddef> // For std::ptrdiff_t
+#include <type_traits> // For std::void_t and type checks
+#include <unordered_set> // For the probe set of remove_all
+#include <utility> // For std::move and std::forward
+#include <thread> // For the parallel sort
+#include <mutex> // For guarding the caches filled in by const traversals
+#include <exception> // For std::exception_ptr (errors raised on worker threads)
+#include <cstdint> // For fixed-width radix keys
+#include <cstring> // For std::memcpy (raw bits of floating point keys)
+#include <limits> // For std::numeric_limits
+#include <cmath> // For std::ceil (percentile rank)
+#include <array> // For the index pool, the compress tables of the vectorised remove and the statistics
+
+// Optional activity counters, compiled in only when MYCONTAINER_ENABLE_STATS is defined
+#ifdef MYCONTAINER_ENABLE_STATS
+#include <chrono> // For timing sorts
+#include <sstream> // For the JSON dump
+#include <string>
+#define MYCONTAINER_STAT(statement) statement
+#else
+#define MYCONTAINER_STAT(statement)
+#endif
+
+// Vectorised remove for arithmetic types: AVX2 kernels compiled for x86 with GCC/Clang, selected at runtime
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MYCONTAINER_SIMD_REMOVE 1
+#include <immintrin.h> // For the AVX2 intrinsics
+#else
+#define MYCONTAINER_SIMD_REMOVE 0
+#endif
+
+// Hint the CPU to start loading an address that will be read soon (a no-op on compilers without the builtin)
+#if defined(__GNUC__) || defined(__clang__)
+#define MYCONTAINER_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define MYCONTAINER_PREFETCH(address) static_cast<void>(address)
+#endif
 
 namespace my_container {
-    template <typename T = int> // Default type is int
+    namespace detail {
+        // Detects whether std::hash<U> is usable (selects the probe set of remove_all)
+        template <typename U, typename = void>
+        struct is_hashable : std::false_type {};
+
+        template <typename U>
+        struct is_hashable<U, std::void_t<decltype(std::hash<U>{}(std::declval<const U&>()))>> : std::true_type {};
+
+        // Detects types whose order can be reproduced by an LSD radix sort on their bits
+        // (integers except bool, and 32/64-bit IEEE floating point)
+        template <typename U>
+        struct is_radix_sortable : std::integral_constant<bool,
+            (std::is_integral<U>::value && !std::is_same<U, bool>::value) ||
+            (std::is_floating_point<U>::value && std::numeric_limits<U>::is_iec559 && (sizeof(U) == 4 || sizeof(U) == 8))> {};
+
+        // Map a value to an unsigned key whose unsigned order matches the order of the values
+        template <typename U>
+        auto radix_key(U value) {
+            if constexpr (std::is_integral<U>::value) {
+                using Key = typename std::make_unsigned<U>::type;
+                Key key = static_cast<Key>(value);
+
+                // Flip the sign bit so negative numbers come before positive ones
+                if constexpr (std::is_signed<U>::value) {
+                    key ^= static_cast<Key>(Key(1) << (sizeof(U) * 8 - 1));
+                }
+                return key;
+            }
+            else {
+                using Key = typename std::conditional<sizeof(U) == 4, std::uint32_t, std::uint64_t>::type;
+                const Key sign_bit = Key(1) << (sizeof(U) * 8 - 1);
+
+                if (value == 0) {
+                    value = 0; // -0.0 and +0.0 compare equal, so they must get the same key
+                }
+
+                Key key;
+                std::memcpy(&key, &value, sizeof(key)); // Raw IEEE bits
+
+                // Negative numbers: flip all bits (reverses their order), positive numbers: set the sign bit
+                return (key & sign_bit) ? static_cast<Key>(~key) : static_cast<Key>(key | sign_bit);
+            }
+        }
+
+        // Run task(0) ... task(count - 1) concurrently, one on the calling thread and the rest on new threads
+        // The first exception thrown by a task is rethrown once all of them finished
+        template <typename Task>
+        void run_in_threads(size_t count, Task task) {
+            if (count == 1) {
+                task(0); // Nothing to spawn, so nothing to allocate
+                return;
+            }
+
+            std::vector<std::exception_ptr> errors(count); // Exception thrown by each task (if any)
+            std::vector<std::thread> workers; // Threads running tasks 1 ... count - 1
+            workers.reserve(count);
+
+            auto guarded = [&task, &errors](size_t i) {
+                try {
+                    task(i);
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            };
+
+            for (size_t i = 1; i < count; ++i) {
+                workers.emplace_back(guarded, i);
+            }
+            guarded(0); // The calling thread takes the first task
+
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+
+            for (const std::exception_ptr& error : errors) {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+        // Parallel merge sort: sort one chunk per thread, then merge adjacent runs pairwise in parallel
+        // With a strict total order (no equivalent elements) the result is identical to std::sort
+        template <typename Vector, typename Compare>
+        void parallel_sort(Vector& values, Compare less, size_t threads) {
+            size_t n = values.size();
+            threads = std::min(threads, n);
+            if (threads < 2) {
+                std::sort(values.begin(), values.end(), less);
+                return;
+            }
+
+            // Boundaries of the sorted runs: run i is [bounds[i], bounds[i + 1]) (allocated like values)
+            using SizeAllocator = typename std::allocator_traits<typename Vector::allocator_type>::template rebind_alloc<size_t>;
+            std::vector<size_t, SizeAllocator> bounds(threads + 1, 0, SizeAllocator(values.get_allocator()));
+            for (size_t i = 0; i <= threads; ++i) {
+                bounds[i] = n * i / threads;
+            }
+
+            // Sort every chunk on its own thread
+            run_in_threads(threads, [&values, &bounds, &less](size_t i) {
+                std::sort(values.begin() + bounds[i], values.begin() + bounds[i + 1], less);
+            });
+
+            // Merge adjacent runs until a single run is left
+            Vector buffer(values); // Same size and allocator (copying also works for types without a default constructor)
+            while (bounds.size() > 2) {
+                size_t runs = bounds.size() - 1;
+                size_t pairs = runs / 2;
+
+                run_in_threads(pairs, [&values, &buffer, &bounds, &less](size_t i) {
+                    auto first = values.begin();
+                    std::merge(first + bounds[2 * i], first + bounds[2 * i + 1],
+                               first + bounds[2 * i + 1], first + bounds[2 * i + 2],
+                               buffer.begin() + bounds[2 * i], less);
+                });
+
+                // An odd run out is carried over unchanged
+                if (runs % 2 == 1) {
+                    std::copy(values.begin() + bounds[runs - 1], values.end(), buffer.begin() + bounds[runs - 1]);
+                }
+
+                values.swap(buffer);
+
+                // Every merged pair becomes a single run
+                std::vector<size_t, SizeAllocator> merged_bounds(bounds.get_allocator());
+                for (size_t i = 0; i < bounds.size(); i += 2) {
+                    merged_bounds.push_back(bounds[i]);
+                }
+                if (merged_bounds.back() != n) {
+                    merged_bounds.push_back(n);
+                }
+                bounds.swap(merged_bounds);
+            }
+        }
+
+        // LSD radix sort of indices by the values they refer to, one byte per pass
+        // The sort is stable, so indices given in increasing order keep increasing order among equal values
+        // threads > 1 splits every pass into contiguous chunks: each thread counts its chunk's bytes, then scatters
+        // its chunk behind the chunks before it in every bucket, which keeps the sort stable
+        // All scratch is allocated with (a rebound copy of) the allocator of indices
+        template <typename Values, typename Indices>
+        void radix_sort_indices(const Values& values, Indices& indices, size_t threads = 1) {
+            using Index = typename Indices::value_type;
+            using Key = decltype(radix_key(values[0]));
+            constexpr size_t passes = sizeof(Key); // One pass per key byte
+
+            // Decorate: contiguous (key, index) pairs, so passes never touch values again
+            struct Entry {
+                Key key;
+                Index index;
+            };
+
+            using Traits = std::allocator_traits<typename Indices::allocator_type>;
+            using EntryAllocator = typename Traits::template rebind_alloc<Entry>;
+            using SizeAllocator = typename Traits::template rebind_alloc<size_t>;
+            SizeAllocator size_allocator(indices.get_allocator());
+
+            size_t n = indices.size();
+            threads = std::max<size_t>(1, std::min(threads, n));
+            std::vector<Entry, EntryAllocator> entries(n, Entry{}, EntryAllocator(indices.get_allocator()));
+            std::vector<Entry, EntryAllocator> buffer(n, Entry{}, entries.get_allocator());
+
+            // Chunk t is [bounds[t], bounds[t + 1])
+            std::vector<size_t, SizeAllocator> bounds(threads + 1, 0, size_allocator);
+            for (size_t t = 0; t <= threads; ++t) {
+                bounds[t] = n * t / threads;
+            }
+
+            // Histogram of every key byte per chunk, computed in a single pass
+            std::vector<size_t, SizeAllocator> counts(threads * passes * 256, 0, size_allocator);
+            run_in_threads(threads, [&](size_t t) {
+                size_t* chunk_counts = &counts[t * passes * 256];
+                for (size_t i = bounds[t]; i < bounds[t + 1]; ++i) {
+                    Key key = radix_key(values[indices[i]]);
+                    entries[i] = Entry{key, indices[i]};
+                    for (size_t pass = 0; pass < passes; ++pass) {
+                        ++chunk_counts[pass * 256 + ((key >> (pass * 8)) & 0xFF)];
+                    }
+                }
+            });
+
+            std::vector<size_t, SizeAllocator> offsets(threads * 256, 0, size_allocator); // Where chunk t writes its next entry of each bucket
+            bool scattered = false; // Entries moved since the histogram was taken
+            for (size_t pass = 0; pass < passes; ++pass) {
+                // Skip bytes that are equal in all keys (e.g. high bytes of small numbers)
+                bool uniform = false;
+                for (size_t bucket = 0; bucket < 256 && !uniform; ++bucket) {
+                    size_t total = 0;
+                    for (size_t t = 0; t < threads; ++t) {
+                        total += counts[(t * passes + pass) * 256 + bucket];
+                    }
+                    uniform = (total == n);
+                }
+                if (uniform) {
+                    continue;
+                }
+
+                // Per-chunk counts of this byte (chunks hold other entries once a pass scattered them, totals do not change)
+                if (threads > 1 && scattered) {
+                    run_in_threads(threads, [&](size_t t) {
+                        size_t* chunk_counts = &offsets[t * 256];
+                        std::fill(chunk_counts, chunk_counts + 256, 0);
+                        for (size_t i = bounds[t]; i < bounds[t + 1]; ++i) {
+                            ++chunk_counts[(entries[i].key >> (pass * 8)) & 0xFF];
+                        }
+                    });
+                }
+                else {
+                    for (size_t t = 0; t < threads; ++t) {
+                        std::copy_n(&counts[(t * passes + pass) * 256], 256, &offsets[t * 256]);
+                    }
+                }
+
+                // Turn counts into starting offsets: bucket by bucket, chunk by chunk
+                size_t offset = 0;
+                for (size_t bucket = 0; bucket < 256; ++bucket) {
+                    for (size_t t = 0; t < threads; ++t) {
+                        size_t bucket_size = offsets[t * 256 + bucket];
+                        offsets[t * 256 + bucket] = offset;
+                        offset += bucket_size;
+                    }
+                }
+
+                // Stable scatter by the current byte
+                run_in_threads(threads, [&](size_t t) {
+                    size_t* chunk_offsets = &offsets[t * 256];
+                    for (size_t i = bounds[t]; i < bounds[t + 1]; ++i) {
+                        const Entry& entry = entries[i];
+                        buffer[chunk_offsets[(entry.key >> (pass * 8)) & 0xFF]++] = entry;
+                    }
+                });
+                entries.swap(buffer);
+                scattered = true;
+            }
+
+            // Strip the keys
+            for (size_t i = 0; i < n; ++i) {
+                indices[i] = entries[i].index;
+            }
+        }
+
+        // Lane type the vectorised remove compares for U: the float itself, or an unsigned integer of the same size
+        // (integers are equal exactly when their bits are, so signedness does not matter)
+        template <typename U>
+        using simd_lane_t = typename std::conditional<std::is_floating_point<U>::value, U,
+            typename std::conditional<sizeof(U) == 4, std::uint32_t, std::uint64_t>::type>::type;
+
+        // Detects element types remove() can compare 8 (32-bit) or 4 (64-bit) at a time
+        template <typename U>
+        struct is_simd_removable : std::integral_constant<bool, MYCONTAINER_SIMD_REMOVE &&
+            ((std::is_integral<U>::value && !std::is_same<U, bool>::value && (sizeof(U) == 4 || sizeof(U) == 8)) ||
+             std::is_same<U, float>::value || std::is_same<U, double>::value)> {};
+
+#if MYCONTAINER_SIMD_REMOVE
+        // Whether the running CPU supports AVX2 (checked once)
+        inline bool cpu_has_avx2() {
+#ifdef __AVX2__
+            return true; // Compiled for AVX2 anyway
+#else
+            static const bool supported = __builtin_cpu_supports("avx2");
+            return supported;
+#endif
+        }
+
+        // Compress tables: for every mask of kept lanes, the 32-bit lane order that moves them to the front of a block
+        template <size_t Lanes> // 8 lanes of 32 bits or 4 lanes of 64 bits
+        const std::array<std::array<std::uint32_t, 8>, (1u << Lanes)>& compress_table() {
+            static const auto table = [] {
+                std::array<std::array<std::uint32_t, 8>, (1u << Lanes)> result{};
+                constexpr size_t words = 8 / Lanes; // 32-bit words per lane
+                for (size_t keep = 0; keep < result.size(); ++keep) {
+                    size_t out = 0;
+                    for (size_t lane = 0; lane < Lanes; ++lane) {
+                        if (keep & (size_t(1) << lane)) {
+                            for (size_t word = 0; word < words; ++word) {
+                                result[keep][out++] = static_cast<std::uint32_t>(lane * words + word);
+                            }
+                        }
+                    }
+                }
+                return result;
+            }();
+            return table;
+        }
+
+        // Bit mask of the lanes of a block equal to element (IEEE equality for floats, like operator==)
+        __attribute__((target("avx2"))) inline int equal_lanes(__m256i block, std::uint32_t element) {
+            __m256i equal = _mm256_cmpeq_epi32(block, _mm256_set1_epi32(static_cast<int>(element)));
+            return _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+        }
+
+        __attribute__((target("avx2"))) inline int equal_lanes(__m256i block, std::uint64_t element) {
+            __m256i equal = _mm256_cmpeq_epi64(block, _mm256_set1_epi64x(static_cast<long long>(element)));
+            return _mm256_movemask_pd(_mm256_castsi256_pd(equal));
+        }
+
+        __attribute__((target("avx2"))) inline int equal_lanes(__m256i block, float element) {
+            return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_castsi256_ps(block), _mm256_set1_ps(element), _CMP_EQ_OQ));
+        }
+
+        __attribute__((target("avx2"))) inline int equal_lanes(__m256i block, double element) {
+            return _mm256_movemask_pd(_mm256_cmp_pd(_mm256_castsi256_pd(block), _mm256_set1_pd(element), _CMP_EQ_OQ));
+        }
+
+        // Lane at a position, read without assuming the storage was written as a Lane
+        template <typename Lane>
+        Lane load_lane(const Lane* values, size_t i) {
+            Lane value;
+            std::memcpy(&value, values + i, sizeof(Lane));
+            return value;
+        }
+
+        // Position of the first lane equal to element, or n if there is none
+        template <typename Lane>
+        __attribute__((target("avx2"))) size_t find_equal_avx2(const Lane* values, size_t n, Lane element) {
+            constexpr size_t lanes = 32 / sizeof(Lane);
+            size_t i = 0;
+            for (; i + lanes <= n; i += lanes) {
+                __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+                if (int equal = equal_lanes(block, element)) {
+                    return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(equal)));
+                }
+            }
+            for (; i < n; ++i) {
+                if (load_lane(values, i) == element) {
+                    return i;
+                }
+            }
+            return n;
+        }
+
+        // Move the lanes different from element to the front, keeping their order, and return how many there are
+        // Each block is compared at once, its survivors are packed with one permute and written with one store
+        // (the store may spill past the survivors, but only over lanes that were already read)
+        template <typename Lane>
+        __attribute__((target("avx2"))) size_t remove_equal_avx2(Lane* values, size_t n, Lane element) {
+            constexpr size_t lanes = 32 / sizeof(Lane);
+            constexpr unsigned all_lanes = (1u << lanes) - 1;
+            const auto& table = compress_table<lanes>();
+
+            size_t out = 0; // Survivors written so far
+            size_t i = 0;
+            for (; i + lanes <= n; i += lanes) {
+                __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+                unsigned keep = ~static_cast<unsigned>(equal_lanes(block, element)) & all_lanes;
+                __m256i order = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(table[keep].data()));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + out), _mm256_permutevar8x32_epi32(block, order));
+                out += static_cast<size_t>(__builtin_popcount(keep));
+            }
+
+            // Scalar tail
+            for (; i < n; ++i) {
+                Lane value = load_lane(values, i);
+                if (!(value == element)) {
+                    std::memcpy(values + out++, &value, sizeof(Lane));
+                }
+            }
+            return out;
+        }
+#endif
+    } // namespace detail
+
+    // How the sorted permutation is built
+    enum class SortStrategy {
+        automatic, // indirect for small inputs, otherwise radix when possible, decorated for small trivially copyable types, else indirect
+        indirect, // Sort indices, comparing the values they refer to
+        decorated, // Sort contiguous (value, index) pairs, then strip the values
+        radix // LSD radix sort (integral and IEEE floating point types only)
+    };
+
+    // Kinds of iterators, used to attribute index allocations
+    enum class IteratorKind { ascending, descending, side_cross, reverse, order, middle_out };
+
+#ifdef MYCONTAINER_ENABLE_STATS
+    // Activity counters of a single container
+    struct ContainerStats {
+        static constexpr size_t iterator_kinds = 6; // Number of IteratorKind values
+
+        size_t add_calls = 0; // Calls to add, emplace and append_range
+        size_t remove_calls = 0; // Calls to remove, remove_if and remove_all
+        size_t elements_shifted = 0; // Elements moved towards the front by removals
+        std::array<size_t, iterator_kinds> index_allocations{}; // Index vectors allocated, per iterator kind
+        std::array<size_t, iterator_kinds> index_bytes{}; // Bytes of index vectors allocated, per iterator kind
+        size_t sorts_performed = 0; // Full sorts of the permutation
+        size_t merges_performed = 0; // Appended elements merged into an existing permutation
+        unsigned long long sort_nanoseconds = 0; // Time spent in sorts and merges
+
+        // Index allocations triggered by one iterator kind
+        size_t allocations_for(IteratorKind kind) const {
+            return index_allocations[static_cast<size_t>(kind)];
+        }
+
+        // Bytes of index vectors allocated for one iterator kind
+        size_t bytes_for(IteratorKind kind) const {
+            return index_bytes[static_cast<size_t>(kind)];
+        }
+
+        // Record an index vector of `bytes` bytes allocated for an iterator kind
+        void record_index_allocation(IteratorKind kind, size_t bytes) {
+            index_allocations[static_cast<size_t>(kind)]++;
+            index_bytes[static_cast<size_t>(kind)] += bytes;
+        }
+
+        // Dump all counters as a JSON object
+        std::string to_json() const {
+            static const char* const kind_names[iterator_kinds] = {
+                "ascending", "descending", "side_cross", "reverse", "order", "middle_out"};
+
+            std::ostringstream os;
+            os << "{\"add_calls\":" << add_calls
+               << ",\"remove_calls\":" << remove_calls
+               << ",\"elements_shifted\":" << elements_shifted
+               << ",\"sorts_performed\":" << sorts_performed
+               << ",\"merges_performed\":" << merges_performed
+               << ",\"sort_nanoseconds\":" << sort_nanoseconds;
+
+            // Per-iterator counters as nested objects
+            const std::array<size_t, iterator_kinds>* groups[2] = {&index_allocations, &index_bytes};
+            const char* group_names[2] = {"index_allocations", "index_bytes"};
+            for (size_t g = 0; g < 2; ++g) {
+                os << ",\"" << group_names[g] << "\":{";
+                for (size_t k = 0; k < iterator_kinds; ++k) {
+                    os << (k == 0 ? "" : ",") << "\"" << kind_names[k] << "\":" << (*groups[g])[k];
+                }
+                os << "}";
+            }
+
+            os << "}";
+            return os.str();
+        }
+    };
+#endif
+
+    // T - element type (default: int)
+    // Alloc - allocator of the elements and, rebound, of the index buffers (default: std::allocator)
+    // Index - unsigned type stored in the index buffers, also caps the number of elements (default: std::uint32_t,
+    //         use std::uint16_t for tiny containers or size_t for containers beyond 4 billion elements)
+    //
+    // Const methods may run concurrently on one container (the caches they fill in are guarded by a mutex),
+    // changes need exclusive access and a single iterator belongs to one thread
+    template <typename T = int, typename Alloc = std::allocator<T>, typename Index = std::uint32_t>
     
     class MyContainer {
+        static_assert(std::is_integral<Index>::value && std::is_unsigned<Index>::value, "Index must be an unsigned integer type");
+
         private:
-            std::vector<T> data; // Internal storage for elements
+            // Index buffers use the container's allocator, rebound to Index
+            using IndexAllocator = typename std::allocator_traits<Alloc>::template rebind_alloc<Index>;
+            using IndexVector = std::vector<Index, IndexAllocator>;
+
+            // Throw if the container would grow beyond what Index can address
+            void check_capacity(size_t new_size) const {
+                if (new_size > max_size()) {
+                    throw std::length_error("MyContainer size exceeds the range of its index type");
+                }
+            }
+
+            std::vector<T, Alloc> data; // Internal storage for elements
+            size_t modification_count = 0; // Bumped by every add/remove
+            size_t removal_count = 0; // Bumped by every remove (adds only append, so they keep the sorted prefix valid)
+
+            // Pool of index buffers lent to iterators (a copied container starts with an empty pool)
+            struct IndexPool {
+                static constexpr size_t capacity = 4; // Buffers kept for reuse
+                // Lent or free buffers (free ones have use_count 1, empty slots are null), fixed so the pool never allocates
+                std::array<std::shared_ptr<IndexVector>, capacity> buffers;
+
+                IndexPool() = default;
+                IndexPool(const IndexPool&) {}
+                IndexPool(IndexPool&&) = default;
+                IndexPool& operator=(const IndexPool&) { return *this; } // Keep our own buffers
+                IndexPool& operator=(IndexPool&&) = default;
+            };
+            mutable IndexPool index_pool;
+
+            // Guards the state const methods fill in (permutation cache, index pool, snapshot and their statistics),
+            // so const traversals of one container may run on several threads (a copied container gets its own mutex)
+            // Recursive, since cache builders borrow from the pool
+            struct CacheMutex {
+                std::recursive_mutex mutex;
+
+                CacheMutex() = default;
+                CacheMutex(const CacheMutex&) {}
+                CacheMutex& operator=(const CacheMutex&) { return *this; }
+            };
+            mutable CacheMutex cache_mutex;
+
+            // Lazily built ascending permutation of data, shared read-only by all sorted iterators
+            mutable std::shared_ptr<IndexVector> sorted_cache;
+            mutable size_t sorted_cache_removals = 0; // removal_count the cache was built for (it covers data[0, size))
+
+            // Lazily built sorted copy of data, shared by all snapshots taken until the next add/remove (which drops it)
+            mutable std::shared_ptr<const std::vector<T, Alloc>> snapshot_cache;
+            mutable size_t snapshot_modifications = 0; // modification_count the snapshot was built for
+
+            // Record that elements were appended: the sorted cache stays valid for the old prefix and new elements are
+            // merged into it on demand, the sorted snapshot no longer matches and is dropped
+            void contents_appended() {
+                ++modification_count;
+                snapshot_cache.reset();
+            }
+
+            // Record that elements were removed: indices shifted, so the sorted cache must be rebuilt from scratch
+            void contents_removed() {
+                contents_appended();
+                ++removal_count;
+            }
+
+#ifdef MYCONTAINER_ENABLE_STATS
+            mutable ContainerStats statistics; // Activity counters (updated from const traversals too)
+#endif
+
+            size_t sort_threads = 1; // Threads used to sort the permutation (1 = serial)
+            size_t parallel_sort_threshold = 1 << 16; // Containers smaller than this are always sorted serially
+
+            SortStrategy sort_strategy = SortStrategy::automatic; // How the permutation is sorted
+
+            static constexpr size_t small_sort_size = 1024; // Below this size a plain indirect sort is fastest
+
+            size_t prefetch_distance = 0; // Positions sorted iterators prefetch ahead of the one being read (0 = off)
+
+            // Copy the contents, caches and settings of other (pool and mutex stay our own); other may be traversed
+            // concurrently, so its caches are read under its lock
+            void copy_from(const MyContainer& other) {
+                std::lock_guard<std::recursive_mutex> lock(other.cache_mutex.mutex);
+                data = other.data;
+                modification_count = other.modification_count;
+                removal_count = other.removal_count;
+                sorted_cache = other.sorted_cache;
+                sorted_cache_removals = other.sorted_cache_removals;
+                snapshot_cache = other.snapshot_cache;
+                snapshot_modifications = other.snapshot_modifications;
+#ifdef MYCONTAINER_ENABLE_STATS
+                statistics = other.statistics;
+#endif
+                sort_threads = other.sort_threads;
+                parallel_sort_threshold = other.parallel_sort_threshold;
+                sort_strategy = other.sort_strategy;
+                prefetch_distance = other.prefetch_distance;
+            }
+
+            // Prefetch the element a sorted traversal will read `prefetch_distance` positions after `position`
+            // permutation - ascending permutation read by the traversal, slot - maps a position to a slot in it
+            template <typename Slot>
+            void prefetch_ahead(const IndexVector& permutation, size_t position, Slot slot) const {
+                size_t ahead = position + prefetch_distance;
+                if (prefetch_distance != 0 && ahead < permutation.size()) {
+                    MYCONTAINER_PREFETCH(&data[permutation[slot(ahead)]]);
+                }
+            }
+
+            // Strategy actually used for n elements: the requested one, or the best one for T when automatic
+            SortStrategy effective_sort_strategy(size_t n) const {
+                if (sort_strategy != SortStrategy::automatic) {
+                    return sort_strategy;
+                }
+                if (n < small_sort_size) {
+                    return SortStrategy::indirect; // Radix passes and decorated copies only pay off on larger inputs
+                }
+                if (detail::is_radix_sortable<T>::value) {
+                    return SortStrategy::radix;
+                }
+                if (std::is_trivially_copyable<T>::value && sizeof(T) <= 16) {
+                    return SortStrategy::decorated; // Small keys are cheaper to copy than to load indirectly
+                }
+                return SortStrategy::indirect;
+            }
+
+            // Comparison sort on a single thread or, for large containers, on several (opt-in)
+            template <typename Vector, typename Compare>
+            void comparison_sort(Vector& values, Compare less) const {
+                if (sort_threads > 1 && values.size() >= parallel_sort_threshold) {
+                    detail::parallel_sort(values, less, sort_threads);
+                }
+                else {
+                    std::sort(values.begin(), values.end(), less);
+                }
+            }
+
+            // Sort indices by the values they refer to (indices arrive in increasing order)
+            // Equal values are ordered by index, so every sort strategy yields the same permutation
+            void sort_indices(IndexVector& indices) const {
+                SortStrategy strategy = effective_sort_strategy(indices.size());
+
+                // Integers and IEEE floats: linear-time radix sort on (key, index) pairs
+                if constexpr (detail::is_radix_sortable<T>::value) {
+                    if (strategy == SortStrategy::radix) {
+                        bool parallel = sort_threads > 1 && indices.size() >= parallel_sort_threshold;
+                        detail::radix_sort_indices(data, indices, parallel ? sort_threads : 1);
+                        return;
+                    }
+                }
+
+                // Decorate-sort-undecorate: sort contiguous (value, index) pairs, then strip the values
+                // Comparisons read adjacent memory instead of two random loads into data
+                if constexpr (std::is_copy_constructible<T>::value) {
+                    if (strategy == SortStrategy::decorated) {
+                        struct Entry {
+                            T key;
+                            Index index;
+                        };
+
+                        using EntryAllocator = typename std::allocator_traits<Alloc>::template rebind_alloc<Entry>;
+                        std::vector<Entry, EntryAllocator> entries{EntryAllocator(data.get_allocator())};
+                        entries.reserve(indices.size());
+                        for (Index index : indices) {
+                            entries.push_back(Entry{data[index], index});
+                        }
+
+                        comparison_sort(entries, [](const Entry& a, const Entry& b) {
+                            return a.key < b.key || (!(b.key < a.key) && a.index < b.index);
+                        });
+
+                        for (size_t i = 0; i < entries.size(); ++i) {
+                            indices[i] = entries[i].index;
+                        }
+                        return;
+                    }
+                }
+
+                // Indirect: sort the indices themselves, comparing the values they refer to
+                comparison_sort(indices, [this](size_t a, size_t b) {
+                    return data[a] < data[b] || (!(data[b] < data[a]) && a < b);
+                });
+            }
+
+            // Borrow an index buffer of n entries from the pool
+            // Buffers no longer referenced by any iterator are reused, so steady-state traversals do not allocate
+            // kind - the iterator asking for it (only used by the statistics)
+            std::shared_ptr<IndexVector> borrow_index_buffer(size_t n, IteratorKind kind) const {
+                static_cast<void>(kind); // Unused when the statistics are compiled out
+                std::lock_guard<std::recursive_mutex> lock(cache_mutex.mutex);
+
+                // Best fit: the smallest free buffer that holds n entries, else the largest one (grown once)
+                auto better = [n](const IndexVector& a, const IndexVector& b) {
+                    bool a_fits = a.capacity() >= n;
+                    if (a_fits != (b.capacity() >= n)) {
+                        return a_fits;
+                    }
+                    return a_fits ? a.capacity() < b.capacity() : a.capacity() > b.capacity();
+                };
+
+                // A buffer only referenced by the pool itself has been returned by all of its borrowers
+                std::shared_ptr<IndexVector>* best = nullptr;
+                for (std::shared_ptr<IndexVector>& buffer : index_pool.buffers) {
+                    if (buffer.use_count() == 1 && (best == nullptr || better(*buffer, **best))) {
+                        best = &buffer;
+                    }
+                }
+                if (best) {
+                    std::shared_ptr<IndexVector> buffer = *best; // Lent now, so the trim below keeps it
+                    if (buffer->capacity() < n) {
+                        MYCONTAINER_STAT(statistics.record_index_allocation(kind, n * sizeof(Index)));
+                        buffer->reserve(n); // Exactly n, a plain resize would grow geometrically (up to twice the permutation)
+                    }
+                    buffer->resize(n);
+                    trim_index_pool(index_pool_budget());
+                    return buffer;
+                }
+
+                // No free buffer - allocate a new one (and keep it for reuse if the pool has room)
+                IndexAllocator index_allocator(data.get_allocator()); // Index buffers live where the elements live
+                auto buffer = std::allocate_shared<IndexVector>(index_allocator, n, index_allocator);
+                MYCONTAINER_STAT(statistics.record_index_allocation(kind, n * sizeof(Index)));
+
+                auto slot = std::find(index_pool.buffers.begin(), index_pool.buffers.end(), nullptr);
+                if (slot != index_pool.buffers.end()) {
+                    *slot = buffer;
+                }
+                return buffer;
+            }
+
+            // Indices the free pool buffers may hold in total: about one permutation of the current contents
+            // (with some slack, so the buffer of a permutation invalidated by a removal can still be reused)
+            size_t index_pool_budget() const {
+                return data.size() + data.size() / 4;
+            }
+
+            // Release free pool buffers, smallest first, until they hold at most `budget` indices in total
+            // Keeps one permutation-sized buffer for reuse without letting rebuilds pile up full-size copies
+            void trim_index_pool(size_t budget) const {
+                std::lock_guard<std::recursive_mutex> lock(cache_mutex.mutex);
+                auto& buffers = index_pool.buffers;
+                while (true) {
+                    size_t free_capacity = 0;
+                    auto smallest = buffers.end();
+                    for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+                        if (it->use_count() == 1) {
+                            free_capacity += (*it)->capacity();
+                            if (smallest == buffers.end() || (*it)->capacity() < (*smallest)->capacity()) {
+                                smallest = it;
+                            }
+                        }
+                    }
+                    if (free_capacity <= budget || smallest == buffers.end()) {
+                        return;
+                    }
+                    smallest->reset();
+                }
+            }
+
+            // Return the ascending permutation of data, sorting only if the container changed since the last build
+            // kind - the iterator asking for it (only used by the statistics)
+            std::shared_ptr<const IndexVector> sorted_permutation(IteratorKind kind) const {
+                std::lock_guard<std::recursive_mutex> lock(cache_mutex.mutex);
+                size_t n = data.size();
+                bool prefix_valid = sorted_cache && sorted_cache_removals == removal_count && sorted_cache->size() <= n;
+
+                // Reuse the cached permutation if it was built for the current contents
+                if (prefix_valid && sorted_cache->size() == n) {
+                    return sorted_cache;
+                }
+
+                MYCONTAINER_STAT(auto sort_start = std::chrono::steady_clock::now());
+
+                // Only elements were appended since the last build: sort the new tail and merge it into the cache
+                // Costs O(k log k + n) for k new elements instead of O(n log n)
+                if (prefix_valid) {
+                    size_t m = sorted_cache->size(); // Elements covered by the cache
+
+                    std::shared_ptr<IndexVector> tail = borrow_index_buffer(n - m, kind); // Indices [m, n)
+                    std::iota(tail->begin(), tail->end(), static_cast<Index>(m));
+                    sort_indices(*tail);
+
+                    std::shared_ptr<IndexVector> merged = borrow_index_buffer(n, kind);
+                    std::merge(sorted_cache->begin(), sorted_cache->end(), tail->begin(), tail->end(), merged->begin(),
+                               [this](size_t a, size_t b) { return data[a] < data[b] || (!(data[b] < data[a]) && a < b); });
+                    MYCONTAINER_STAT(statistics.merges_performed++);
+
+                    sorted_cache = std::move(merged); // Publish the new permutation
+                }
+
+                // Otherwise sort everything from scratch
+                else {
+                    sorted_cache.reset(); // Drop the stale permutation so its buffer can be recycled
+
+                    // Create indices vector: [0, 1, 2, ...]
+                    std::shared_ptr<IndexVector> indices = borrow_index_buffer(n, kind);
+                    std::iota(indices->begin(), indices->end(), Index(0)); // Fill with indices [0, 1, 2, ...]
+                    sort_indices(*indices); // Sort indices by values in the container
+                    MYCONTAINER_STAT(statistics.sorts_performed++);
+
+                    sorted_cache = std::move(indices); // Publish the new permutation
+                    sorted_cache_removals = removal_count; // Stamp it with the current contents
+                }
+
+                MYCONTAINER_STAT(statistics.sort_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - sort_start).count());
+                trim_index_pool(index_pool_budget()); // The replaced permutation and merge buffers are free now
+                return sorted_cache;
+            }
+
+            // Return the cached permutation if it is up to date, or nullptr (never sorts)
+            // Safe to use after the lock is released: a fresh permutation is only replaced by add/remove
+            const IndexVector* fresh_sorted_permutation() const {
+                std::lock_guard<std::recursive_mutex> lock(cache_mutex.mutex);
+                if (sorted_cache && sorted_cache_removals == removal_count && sorted_cache->size() == data.size()) {
+                    return sorted_cache.get();
+                }
+                return nullptr;
+            }
+
+            // Ascending permutation of the k smallest (or largest) elements, holding only k indices
+            // Positions of a top-k traversal match the same positions of a full traversal
+            std::shared_ptr<const IndexVector> top_k_permutation(size_t k, bool largest, IteratorKind kind) const {
+                size_t n = data.size();
+                k = std::min(k, n);
+
+                // An up-to-date full permutation already holds the answer (ascending walks its prefix, descending its suffix)
+                {
+                    std::lock_guard<std::recursive_mutex> lock(cache_mutex.mutex);
+                    if (fresh_sorted_permutation() != nullptr) {
+                        return sorted_cache;
+                    }
+                }
+
+                auto less = [this](size_t a, size_t b) { return data[a] < data[b] || (!(data[b] < data[a]) && a < b); };
+
+                // Heap order with the worst kept index on top (the largest one when keeping the smallest, and vice versa)
+                auto worse = [&less, largest](size_t a, size_t b) { return largest ? less(b, a) : less(a, b); };
+
+                std::shared_ptr<IndexVector> heap = borrow_index_buffer(0, kind);
+                heap->reserve(k);
+
+                // Bounded heap: keep the k best indices seen so far
+                for (size_t i = 0; i < n && k > 0; ++i) {
+                    Index index = static_cast<Index>(i);
+                    if (heap->size() < k) {
+                        heap->push_back(index);
+                        std::push_heap(heap->begin(), heap->end(), worse);
+                    }
+
+                    // The new index beats the worst kept one - replace it
+                    else if (worse(index, heap->front())) {
+                        std::pop_heap(heap->begin(), heap->end(), worse);
+                        heap->back() = index;
+                        std::push_heap(heap->begin(), heap->end(), worse);
+                    }
+                }
+
+                std::sort(heap->begin(), heap->end(), less); // Ascending, like the full permutation
+                return heap;
+            }
+
+            // Progress of an incremental quicksort shared by copies of a lazy iterator
+            // indices converges to the ascending permutation: [0, front) is final for lazy ascending traversals,
+            // [back, n) for lazy descending ones, and pending holds the bounds of the ranges still to partition
+            struct LazySort {
+                std::shared_ptr<IndexVector> indices; // Partially sorted permutation
+                IndexVector pending; // Ascending: final pivot positions (top is the end of the next range, n at the bottom)
+                                     // Descending: pivot positions + 1 (top is the start of the next range, 0 at the bottom)
+                size_t front; // First position not yet final from the left
+                size_t back; // One past the last position not yet final from the right
+                size_t modifications; // modification_count the indices were created for
+
+                LazySort(std::shared_ptr<IndexVector> indices, const IndexAllocator& allocator, size_t front, size_t back,
+                         size_t modifications)
+                    : indices(std::move(indices)), pending(allocator), front(front), back(back), modifications(modifications) {}
+            };
+
+            static constexpr size_t lazy_sort_cutoff = 16; // Ranges this small are sorted outright instead of partitioned
+
+            // Start an incremental sort (or reuse an up-to-date cached permutation, already final everywhere)
+            std::shared_ptr<LazySort> lazy_sort_state(bool descending, IteratorKind kind) const {
+                size_t n = data.size();
+                IndexAllocator index_allocator(data.get_allocator());
+
+                {
+                    std::lock_guard<std::recursive_mutex> lock(cache_mutex.mutex);
+                    if (fresh_sorted_permutation() != nullptr) {
+                        return std::allocate_shared<LazySort>(index_allocator, sorted_cache, index_allocator, n, 0, modification_count);
+                    }
+                }
+
+                std::shared_ptr<IndexVector> indices = borrow_index_buffer(n, kind);
+                std::iota(indices->begin(), indices->end(), Index(0)); // Fill with indices [0, 1, 2, ...]
+                auto state = std::allocate_shared<LazySort>(index_allocator, std::move(indices), index_allocator, 0, n,
+                                                            modification_count);
+                state->pending.push_back(static_cast<Index>(descending ? 0 : n)); // The whole range is unsorted
+                return state;
+            }
+
+            // Partition indices[lo, hi) around a median-of-three pivot and return the pivot's final position
+            template <typename Compare>
+            static size_t lazy_partition(IndexVector& indices, size_t lo, size_t hi, Compare less) {
+                auto first = indices.begin() + lo;
+                auto last = indices.begin() + (hi - 1);
+                auto middle = indices.begin() + (lo + (hi - lo) / 2);
+
+                // Move the median of the first, middle and last index to the end of the range
+                if (less(*middle, *first)) std::iter_swap(middle, first);
+                if (less(*last, *first)) std::iter_swap(last, first);
+                if (less(*middle, *last)) std::iter_swap(middle, last);
+
+                Index pivot = *last;
+                auto split = std::partition(first, last, [&less, pivot](Index index) { return less(index, pivot); });
+                std::iter_swap(split, last);
+                return static_cast<size_t>(split - indices.begin());
+            }
+
+            // Advance an incremental sort until the given traversal position is final and return the permutation
+            // Ascending traversals finalise the permutation from the left, descending ones from the right
+            // Reaching the first m positions costs O(n + m log m) expected, finishing it costs O(n log n) like a full sort
+            const IndexVector& lazy_sorted_permutation(LazySort& state, size_t position, bool descending) const {
+                IndexVector& indices = *state.indices;
+                size_t n = indices.size();
+
+                // Nothing to do if the position is already final
+                if (descending ? n - state.back > position : state.front > position) {
+                    return indices;
+                }
+
+                MYCONTAINER_STAT(auto sort_start = std::chrono::steady_clock::now());
+                auto less = [this](size_t a, size_t b) { return data[a] < data[b] || (!(data[b] < data[a]) && a < b); };
+
+                if (!descending) {
+                    while (state.front <= position) {
+                        size_t end = state.pending.back(); // End of the unsorted range starting at front
+
+                        if (end == state.front) {
+                            state.pending.pop_back(); // A pivot, already in place
+                            state.front++;
+                        }
+                        else if (end - state.front <= lazy_sort_cutoff) {
+                            std::sort(indices.begin() + state.front, indices.begin() + end, less);
+                            state.front = end;
+                        }
+                        else {
+                            state.pending.push_back(static_cast<Index>(lazy_partition(indices, state.front, end, less)));
+                        }
+                    }
+                }
+                else {
+                    while (n - state.back <= position) {
+                        size_t begin = state.pending.back(); // Start of the unsorted range ending at back
+
+                        if (begin == state.back) {
+                            state.pending.pop_back(); // A pivot, already in place
+                            state.back--;
+                        }
+                        else if (state.back - begin <= lazy_sort_cutoff) {
+                            std::sort(indices.begin() + begin, indices.begin() + state.back, less);
+                            state.back = begin;
+                        }
+                        else {
+                            state.pending.push_back(static_cast<Index>(lazy_partition(indices, begin, state.back, less) + 1));
+                        }
+                    }
+                }
+
+                // The sorting progress belongs to this iterator (and its copies), only the cache and counters are shared
+                std::lock_guard<std::recursive_mutex> lock(cache_mutex.mutex);
+                MYCONTAINER_STAT(statistics.sort_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - sort_start).count());
+
+                // Fully sorted: publish it as the cached permutation if the container has not changed meanwhile
+                if ((state.front == n || state.back == 0) && state.modifications == modification_count &&
+                    fresh_sorted_permutation() == nullptr) {
+                    MYCONTAINER_STAT(statistics.sorts_performed++);
+                    sorted_cache = state.indices;
+                    sorted_cache_removals = removal_count;
+                }
+                return indices;
+            }
+
+            // Gather the values visited by an iterator into one reused buffer, chunk by chunk, and pass each chunk to fn
+            template <typename Iterator, typename Function>
+            void gather_chunks(const Iterator& it, size_t chunk_size, Function& fn) const {
+                size_t n = data.size();
+                std::vector<T, Alloc> chunk(data.get_allocator()); // Gathered values of the current chunk
+                chunk.reserve(std::min(chunk_size, n));
+
+                for (size_t start = 0; start < n; start += chunk_size) {
+                    size_t count = std::min(chunk_size, n - start);
+
+                    // Assign over the previous chunk when possible (keeps e.g. string capacity), else rebuild it
+                    if constexpr (std::is_default_constructible<T>::value && std::is_copy_assignable<T>::value) {
+                        chunk.resize(count);
+                        for (size_t i = 0; i < count; ++i) {
+                            chunk[i] = data[it.index_at(start + i)];
+                        }
+                    }
+                    else {
+                        chunk.clear();
+                        for (size_t i = 0; i < count; ++i) {
+                            chunk.push_back(data[it.index_at(start + i)]);
+                        }
+                    }
+                    fn(static_cast<const T*>(chunk.data()), count);
+                }
+            }
+
+#if MYCONTAINER_SIMD_REMOVE
+            // Vectorised remove (same result, statistics and exception as the remove_if path)
+            void remove_equal_simd(const T& element) {
+                MYCONTAINER_STAT(statistics.remove_calls++);
+
+                using Lane = detail::simd_lane_t<T>;
+                Lane key;
+                std::memcpy(&key, &element, sizeof(Lane));
+                Lane* values = reinterpret_cast<Lane*>(data.data());
+                size_t n = data.size();
+
+                // Find the first element to remove (everything before it stays in place)
+                size_t first = detail::find_equal_avx2(values, n, key);
+
+                // If no element matched, throw an exception
+                if (first == n) {
+                    throw std::runtime_error("Element not found");
+                }
+
+                // Compact the survivors after it to the front, then drop the tail once
+                size_t new_size = first + detail::remove_equal_avx2(values + first, n - first, key);
+                MYCONTAINER_STAT(statistics.elements_shifted += new_size - first);
+
+                data.erase(data.begin() + static_cast<std::ptrdiff_t>(new_size), data.end());
+                contents_removed();
+            }
+#endif
 
         public:
             // Forward declaration of iterator classes
@@ -23,49 +1039,349 @@ namespace my_container {
             class ReverseOrder; // Iterator for reverse order
             class Order; // Iterator for regular order
             class MiddleOutOrder; // Iterator for middle-out order
+            class LazyAscendingOrder; // Iterator for ascending order, sorting as it advances
+            class LazyDescendingOrder; // Iterator for descending order, sorting as it advances
+            class SortedSnapshot; // Immutable sorted copy of the elements
 
             // Default constructor
             MyContainer() = default;
 
+            // Constructor with an allocator for the elements (and, rebound, for the index buffers)
+            explicit MyContainer(const Alloc& allocator) : data(allocator) {}
+
+            // Copy constructor (safe while other is being traversed on another thread)
+            MyContainer(const MyContainer& other)
+                : data(std::allocator_traits<Alloc>::select_on_container_copy_construction(other.data.get_allocator())) {
+                copy_from(other);
+            }
+
+            // Copy assignment (safe while other is being traversed on another thread)
+            MyContainer& operator=(const MyContainer& other) {
+                if (this != &other) {
+                    copy_from(other);
+                }
+                return *this;
+            }
+
+            // Moving needs exclusive access to other anyway, so it takes no lock
+            MyContainer(MyContainer&&) = default;
+            MyContainer& operator=(MyContainer&&) = default;
+
+            // Return the allocator of the container
+            Alloc get_allocator() const {
+                return data.get_allocator();
+            }
+
             // Add a new element to the container
             void add(const T& element) {
+                check_capacity(data.size() + 1); // Every element must be addressable by Index
                 data.push_back(element); // Add element to the end of the vector
+                contents_appended();
+                MYCONTAINER_STAT(statistics.add_calls++);
+            }
+
+            // Add a new element to the container by moving it (no copy for movable types)
+            void add(T&& element) {
+                check_capacity(data.size() + 1); // Every element must be addressable by Index
+                data.push_back(std::move(element)); // Move element to the end of the vector
+                contents_appended();
+                MYCONTAINER_STAT(statistics.add_calls++);
+            }
+
+            // Construct a new element in place at the end of the container
+            template <typename... Args>
+            void emplace(Args&&... args) {
+                check_capacity(data.size() + 1); // Every element must be addressable by Index
+                data.emplace_back(std::forward<Args>(args)...); // Construct directly inside the vector
+                contents_appended();
+                MYCONTAINER_STAT(statistics.add_calls++);
+            }
+
+            // Add all elements of [first, last) to the container with a single reservation
+            template <typename InputIt>
+            void append_range(InputIt first, InputIt last) {
+                using category = typename std::iterator_traits<InputIt>::iterator_category;
+
+                // Forward ranges know their length up front, so grow the storage exactly once
+                if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+                    size_t new_size = data.size() + static_cast<size_t>(std::distance(first, last));
+                    check_capacity(new_size); // Every element must be addressable by Index
+                    data.reserve(new_size);
+                }
+
+                size_t old_size = data.size(); // Remember the size to detect an empty range
+                data.insert(data.end(), first, last); // Copy (or move, through move iterators) the range in
+
+                // Single-pass ranges can only be checked afterwards (roll back if they were too long)
+                if (data.size() > max_size()) {
+                    size_t new_size = data.size();
+                    data.erase(data.begin() + old_size, data.end());
+                    check_capacity(new_size); // Throws
+                }
+                MYCONTAINER_STAT(statistics.add_calls++);
+
+                if (data.size() != old_size) {
+                    contents_appended();
+                }
+            }
+
+            // Reserve storage for at least new_capacity elements
+            void reserve(size_t new_capacity) {
+                data.reserve(new_capacity);
+            }
+
+            // Return number of elements the container can hold without reallocating
+            size_t capacity() const {
+                return data.capacity();
+            }
+
+            // Release unused storage (spare element capacity and index buffers no iterator holds)
+            void shrink_to_fit() {
+                data.shrink_to_fit();
+                trim_index_pool(0); // Release every index buffer no iterator or cache still uses
             }
 
             // Remove all occurrences of a specific element from the container
+            // Integers of 4 or 8 bytes, float and double are compared 8 or 4 at a time when the CPU supports AVX2
             void remove(const T& element) {
-                bool found = false; // Flag to check if the element was found
-                auto it = data.begin(); // Iterator to traverse the vector
-
-                // Iterate through the vector to find and remove the element
-                while (it != data.end()) {
-                    // If the current element matches the one to remove
-                    if (*it == element) {
-                        it = data.erase(it); // erase returns iterator to next element
-                        found = true; // Set found to true
+#if MYCONTAINER_SIMD_REMOVE
+                if constexpr (detail::is_simd_removable<T>::value) {
+                    if (detail::cpu_has_avx2()) {
+                        remove_equal_simd(element);
+                        return;
                     }
-                    
-                    // If the current element does not match, move to the next element
-                    else {
-                        ++it; // Move iterator to the next element
+                }
+#endif
+                remove_if([&element](const T& value) { return value == element; }); // Single-pass compaction
+            }
+
+            // Remove all elements matching a predicate (throws if none matched)
+            template <typename Predicate>
+            void remove_if(Predicate predicate) {
+                MYCONTAINER_STAT(statistics.remove_calls++);
+
+                // Find the first element to remove (everything before it stays in place)
+                auto first = std::find_if(data.begin(), data.end(), predicate);
+
+                // If no element matched, throw an exception
+                if (first == data.end()) {
+                    throw std::runtime_error("Element not found");
+                }
+
+                // Compact the survivors after it to the front in one pass, then drop the tail once
+                auto new_end = std::remove_if(first, data.end(), predicate);
+                MYCONTAINER_STAT(statistics.elements_shifted += static_cast<size_t>(new_end - first));
+
+                data.erase(new_end, data.end()); // Drop the removed elements from the end
+                contents_removed();
+            }
+
+            // Remove all occurrences of every value in a range (throws if none was found)
+            template <typename Range>
+            void remove_all(const Range& values) {
+                // Hashable types are probed through a hash set
+                if constexpr (detail::is_hashable<T>::value) {
+                    std::unordered_set<T> probe(std::begin(values), std::end(values));
+                    remove_if([&probe](const T& value) { return probe.count(value) != 0; });
+                }
+
+                // Other types are probed through a sorted vector with binary search
+                else {
+                    std::vector<T> probe(std::begin(values), std::end(values));
+                    std::sort(probe.begin(), probe.end());
+                    remove_if([&probe](const T& value) { return std::binary_search(probe.begin(), probe.end(), value); });
+                }
+            }
+
+            // Set the number of threads used to sort large containers (1 = serial, the default)
+            // Used by every strategy: comparison sorts merge per-thread runs, radix sort splits each pass into chunks
+            void set_sort_threads(size_t threads) {
+                sort_threads = std::max<size_t>(threads, 1);
+            }
+
+            // Choose how the sorted permutation is built (automatic by default)
+            // Throws std::invalid_argument if T cannot be sorted with the requested strategy
+            void set_sort_strategy(SortStrategy strategy) {
+                if (strategy == SortStrategy::radix && !detail::is_radix_sortable<T>::value) {
+                    throw std::invalid_argument("Radix sort needs an integral or IEEE floating point type");
+                }
+                if (strategy == SortStrategy::decorated && !std::is_copy_constructible<T>::value) {
+                    throw std::invalid_argument("Decorated sort needs a copyable type");
+                }
+                sort_strategy = strategy;
+            }
+
+            // Set the minimal size from which sorting is split across threads
+            void set_parallel_sort_threshold(size_t threshold) {
+                parallel_sort_threshold = threshold;
+            }
+
+            // Set how many positions ahead the sorted iterators prefetch the element they will read (0, the default, disables it)
+            // Sorted traversals read data in permutation order, so on large containers nearly every read misses the cache
+            // Plain scans already overlap those misses, prefetching pays off when the work per element is heavy
+            void set_prefetch_distance(size_t distance) {
+                prefetch_distance = distance;
+            }
+
+#ifdef MYCONTAINER_ENABLE_STATS
+            // Activity counters of this container
+            const ContainerStats& stats() const {
+                return statistics;
+            }
+
+            // Reset all activity counters
+            void reset_stats() {
+                statistics = ContainerStats();
+            }
+#endif
+
+            // Return number of elements in the container
+            size_t size() const {
+                return data.size(); // Return the size of the vector
+            }
+
+            // Return the maximal number of elements (limited by the index type)
+            size_t max_size() const {
+                return std::min<size_t>(data.max_size(), std::numeric_limits<Index>::max());
+            }
+
+            // Order statistics
+            // Each query uses the cached sorted permutation when it is up to date, and never sorts otherwise
+
+            // Return the k-th smallest element (k = 0 is the minimum), throws std::out_of_range if k >= size()
+            // O(1) with an up-to-date sorted permutation, otherwise O(n) expected (std::nth_element on indices)
+            const T& kth_smallest(size_t k) const {
+                if (k >= data.size()) {
+                    throw std::out_of_range("kth_smallest: k is out of range");
+                }
+
+                if (const IndexVector* sorted = fresh_sorted_permutation()) {
+                    return data[(*sorted)[k]];
+                }
+
+                // Select on a borrowed index buffer (the elements are neither copied nor reordered)
+                std::shared_ptr<IndexVector> indices = borrow_index_buffer(data.size(), IteratorKind::ascending);
+                std::iota(indices->begin(), indices->end(), Index(0));
+                std::nth_element(indices->begin(), indices->begin() + k, indices->end(),
+                                 [this](size_t a, size_t b) { return data[a] < data[b] || (!(data[b] < data[a]) && a < b); });
+                return data[(*indices)[k]];
+            }
+
+            // Return the number of elements strictly smaller than value
+            // O(log n) with an up-to-date sorted permutation, otherwise O(n)
+            size_t rank(const T& value) const {
+                if (const IndexVector* sorted = fresh_sorted_permutation()) {
+                    auto first_not_less = std::lower_bound(sorted->begin(), sorted->end(), value,
+                        [this](Index index, const T& key) { return data[index] < key; });
+                    return static_cast<size_t>(first_not_less - sorted->begin());
+                }
+
+                return static_cast<size_t>(std::count_if(data.begin(), data.end(),
+                    [&value](const T& element) { return element < value; }));
+            }
+
+            // Return the number of elements x with lo <= x <= hi
+            // O(log n) with an up-to-date sorted permutation, otherwise O(n)
+            size_t count_in_range(const T& lo, const T& hi) const {
+                if (hi < lo) {
+                    return 0; // Empty range
+                }
+
+                if (const IndexVector* sorted = fresh_sorted_permutation()) {
+                    auto first = std::lower_bound(sorted->begin(), sorted->end(), lo,
+                        [this](Index index, const T& key) { return data[index] < key; });
+                    auto last = std::upper_bound(first, sorted->end(), hi,
+                        [this](const T& key, Index index) { return key < data[index]; });
+                    return static_cast<size_t>(last - first);
+                }
+
+                return static_cast<size_t>(std::count_if(data.begin(), data.end(),
+                    [&lo, &hi](const T& element) { return !(element < lo) && !(hi < element); }));
+            }
+
+            // Return the p-th percentile (nearest-rank method, p in [0, 100])
+            // Throws std::out_of_range for an empty container or p outside [0, 100]
+            const T& percentile(double p) const {
+                if (data.empty() || !(p >= 0.0 && p <= 100.0)) {
+                    throw std::out_of_range("percentile: empty container or p outside [0, 100]");
+                }
+
+                // Nearest rank: the smallest element with at least p% of the elements at or below it
+                // Multiply before dividing so exact ranks stay exact (p / 100 is rarely representable, 7 / 100 * 100 > 7),
+                // and shave a few ulps so a product that still lands just above an integer does not round up past it
+                double exact_rank = p * static_cast<double>(data.size()) / 100.0;
+                size_t rank = static_cast<size_t>(std::ceil(exact_rank * (1.0 - 4 * std::numeric_limits<double>::epsilon())));
+                return kth_smallest(rank == 0 ? 0 : rank - 1);
+            }
+
+            // Batch traversal: call fn(values, count) for consecutive chunks of at most chunk_size elements in the given order
+            // Insertion order passes spans of the container's own storage, every other order gathers its values into
+            // a contiguous buffer first, so the callback can run vectorisable loops over plain arrays
+            // Throws std::invalid_argument if chunk_size is 0
+            template <typename Function>
+            void for_each_chunk(IteratorKind order, size_t chunk_size, Function fn) const {
+                if (chunk_size == 0) {
+                    throw std::invalid_argument("for_each_chunk: chunk_size must be positive");
+                }
+
+                switch (order) {
+                    case IteratorKind::order:
+                        for (size_t start = 0; start < data.size(); start += chunk_size) {
+                            fn(data.data() + start, std::min(chunk_size, data.size() - start));
+                        }
+                        break;
+                    case IteratorKind::ascending: gather_chunks(begin_ascending_order(), chunk_size, fn); break;
+                    case IteratorKind::descending: gather_chunks(begin_descending_order(), chunk_size, fn); break;
+                    case IteratorKind::side_cross: gather_chunks(begin_side_cross_order(), chunk_size, fn); break;
+                    case IteratorKind::reverse: gather_chunks(begin_reverse_order(), chunk_size, fn); break;
+                    case IteratorKind::middle_out: gather_chunks(begin_middle_out_order(), chunk_size, fn); break;
+                }
+            }
+
+            // Return an immutable, contiguous, sorted copy of the elements
+            // Built in O(n) from the sorted permutation (which is sorted first if stale) and shared until the next add/remove,
+            // after that every scan of the snapshot reads memory sequentially instead of through the permutation
+            SortedSnapshot sorted_snapshot() const {
+                std::lock_guard<std::recursive_mutex> lock(cache_mutex.mutex);
+                if (!snapshot_cache || snapshot_modifications != modification_count) {
+                    snapshot_cache.reset(); // Drop the stale copy before building the new one
+
+                    std::shared_ptr<const IndexVector> ascending = sorted_permutation(IteratorKind::ascending);
+                    auto values = std::allocate_shared<std::vector<T, Alloc>>(data.get_allocator(), data.get_allocator());
+                    values->reserve(ascending->size());
+                    for (Index index : *ascending) {
+                        values->push_back(data[index]); // One gather, in ascending order
                     }
+
+                    snapshot_cache = std::move(values);
+                    snapshot_modifications = modification_count;
                 }
-                
-                // If the element was not found, throw an exception
-                if (!found) {
-                    throw std::runtime_error("Element not found");
-                }
+                return SortedSnapshot(snapshot_cache);
             }
 
-            // Return number of elements in the container
-            size_t size() const {
-                return data.size(); // Return the size of the vector
+            // Return the elements sorted in ascending order
+            // Copies the current snapshot if there is one, otherwise gathers straight from the permutation (caches no copy)
+            std::vector<T, Alloc> to_sorted_vector() const {
+                {
+                    std::lock_guard<std::recursive_mutex> lock(cache_mutex.mutex);
+                    if (snapshot_cache && snapshot_modifications == modification_count) {
+                        return *snapshot_cache;
+                    }
+                }
+
+                std::shared_ptr<const IndexVector> ascending = sorted_permutation(IteratorKind::ascending);
+                std::vector<T, Alloc> values(data.get_allocator());
+                values.reserve(ascending->size());
+                for (Index index : *ascending) {
+                    values.push_back(data[index]);
+                }
+                return values;
             }
 
-            template <typename U> // Template declaration for friend function
+            template <typename U, typename A, typename I> // Template declaration for friend function
 
             // Output operator (declaration of friend function)
-            friend std::ostream& operator<<(std::ostream& os, const MyContainer<U>& container);
+            friend std::ostream& operator<<(std::ostream& os, const MyContainer<U, A, I>& container);
 
             // Begin iterator for AscendingOrder
             AscendingOrder begin_ascending_order() const {
@@ -74,9 +1390,7 @@ namespace my_container {
 
             // End iterator for AscendingOrder
             AscendingOrder end_ascending_order() const {
-                AscendingOrder it(*this); // Create an iterator for the end state
-                it.current_position = data.size(); // "End" state
-                return it;
+                return AscendingOrder(*this, data.size()); // Position-only iterator for the "end" state
             }
 
             // Begin iterator for DescendingOrder
@@ -86,9 +1400,49 @@ namespace my_container {
 
             // End iterator for DescendingOrder
             DescendingOrder end_descending_order() const {
-                DescendingOrder it(*this); // Create an iterator for the end state
-                it.current_position = data.size(); // "End" state
-                return it;
+                return DescendingOrder(*this, data.size()); // Position-only iterator for the "end" state
+            }
+
+            // Begin iterator over the k smallest elements in ascending order (O(n log k) unless already sorted)
+            AscendingOrder begin_ascending_order(size_t k) const {
+                return AscendingOrder(*this, top_k_permutation(k, false, IteratorKind::ascending));
+            }
+
+            // End iterator over the k smallest elements (decrementing it selects the k smallest, like the begin iterator)
+            AscendingOrder end_ascending_order(size_t k) const {
+                k = std::min(k, data.size());
+                return AscendingOrder(*this, k, k); // Position-only iterator for the "end" state
+            }
+
+            // Begin iterator over the k largest elements in descending order (O(n log k) unless already sorted)
+            DescendingOrder begin_descending_order(size_t k) const {
+                return DescendingOrder(*this, top_k_permutation(k, true, IteratorKind::descending));
+            }
+
+            // End iterator over the k largest elements (decrementing it selects the k largest, like the begin iterator)
+            DescendingOrder end_descending_order(size_t k) const {
+                k = std::min(k, data.size());
+                return DescendingOrder(*this, k, k); // Position-only iterator for the "end" state
+            }
+
+            // Begin iterator for LazyAscendingOrder (no sorting until the first element is read)
+            LazyAscendingOrder begin_lazy_ascending_order() const {
+                return LazyAscendingOrder(*this);
+            }
+
+            // End iterator for LazyAscendingOrder
+            LazyAscendingOrder end_lazy_ascending_order() const {
+                return LazyAscendingOrder(*this, data.size()); // Position-only iterator for the "end" state
+            }
+
+            // Begin iterator for LazyDescendingOrder (no sorting until the first element is read)
+            LazyDescendingOrder begin_lazy_descending_order() const {
+                return LazyDescendingOrder(*this);
+            }
+
+            // End iterator for LazyDescendingOrder
+            LazyDescendingOrder end_lazy_descending_order() const {
+                return LazyDescendingOrder(*this, data.size()); // Position-only iterator for the "end" state
             }
 
             // Begin iterator for SideCrossOrder
@@ -98,9 +1452,7 @@ namespace my_container {
 
             // End iterator for SideCrossOrder
             SideCrossOrder end_side_cross_order() const {
-                SideCrossOrder it(*this); // Create an iterator for the end state
-                it.current_position = data.size(); // "End" state
-                return it;
+                return SideCrossOrder(*this, data.size()); // Position-only iterator for the "end" state
             }
 
             // Begin iterator for ReverseOrder
@@ -110,9 +1462,7 @@ namespace my_container {
 
             // End iterator for ReverseOrder
             ReverseOrder end_reverse_order() const {
-                ReverseOrder it(*this); // Create an iterator for the end state
-                it.current_position = data.size(); // "End" state
-                return it;
+                return ReverseOrder(*this, data.size()); // Position-only iterator for the "end" state
             }
 
             // Begin iterator for Order
@@ -122,9 +1472,7 @@ namespace my_container {
 
             // End iterator for Order
             Order end_order() const {
-                Order it(*this); // Create an iterator for the end state
-                it.current_position = data.size(); // "End" state
-                return it;
+                return Order(*this, data.size()); // Position-only iterator for the "end" state
             }
 
             // Begin iterator for MiddleOutOrder
@@ -134,351 +1482,610 @@ namespace my_container {
 
             // End iterator for MiddleOutOrder
             MiddleOutOrder end_middle_out_order() const {
-                MiddleOutOrder it(*this); // Create an iterator for the end state
-                it.current_position = data.size(); // "End" state
-                return it;
+                return MiddleOutOrder(*this, data.size()); // Position-only iterator for the "end" state
             }
 
-            // Iterator for ascending order
-            class AscendingOrder {
-                private:
-                    std::vector<size_t> sorted_indices; // Indices sorted by values
-                    size_t current_position; // Current position in indices
-                    const MyContainer<T>* container_ptr; // Pointer to original container
+            // Common base of the order iterators (CRTP)
+            // Holds the position and the container pointer and provides all random-access operations,
+            // Derived only supplies index_at(position) - the index in data visited at a given position
+            // Sorted iterators keep the permutation in shared, immutable storage, so copying any iterator is O(1)
+            // and never allocates (post-increment and algorithms that copy iterators freely stay cheap)
+            template <typename Derived>
+            class IteratorBase {
+                protected:
+                    size_t current_position; // Current position in the traversal
+                    const MyContainer* container_ptr; // Pointer to original container
 
-                    friend class MyContainer<T>; // To allow MyContainer to access private members
+                    IteratorBase() : current_position(0), container_ptr(nullptr) {}
+                    IteratorBase(const MyContainer& container, size_t position) : current_position(position), container_ptr(&container) {}
+
+                    // Access to the derived iterator
+                    Derived& derived() { return static_cast<Derived&>(*this); }
+                    const Derived& derived() const { return static_cast<const Derived&>(*this); }
 
                 public:
-                    // Constructor - builds the sorted indices vector
-                    AscendingOrder(const MyContainer<T>& container) : container_ptr(&container), current_position(0) {
-                        // Create indices vector: [0, 1, 2, ...]
-                        sorted_indices.resize(container.data.size()); // Initialize with size of data
-                        std::iota(sorted_indices.begin(), sorted_indices.end(), 0); // Fill with indices [0, 1, 2, ...]
-                        
-                        // Sort indices by values in original container
-                        std::sort(sorted_indices.begin(), sorted_indices.end(),
-                                [&container](size_t a, size_t b) { return container.data[a] < container.data[b]; });
-                    }
-                    
+                    // Iterator traits (used by std::iterator_traits)
+                    using iterator_category = std::random_access_iterator_tag;
+                    using value_type = T;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = const T*;
+                    using reference = const T&;
+
                     // Dereference operator - returns current element
-                    const T& operator*() const {
-                        size_t actual_index = sorted_indices[current_position]; // Get the actual index from sorted indices
-                        return container_ptr->data[actual_index]; // Return the element at that index
+                    reference operator*() const {
+                        return container_ptr->data[derived().index_at(current_position)]; // Map the position to an index in data
                     }
-                    
+
+                    // Member access operator - returns pointer to current element
+                    pointer operator->() const {
+                        return &**this;
+                    }
+
+                    // Subscript operator - returns the element n positions away
+                    reference operator[](difference_type n) const {
+                        return container_ptr->data[derived().index_at(current_position + n)];
+                    }
+
                     // Increment operator - moves to next element
-                    AscendingOrder& operator++() {
+                    Derived& operator++() {
                         current_position++; // Increment current position
-                        return *this; // Return the updated iterator
+                        return derived(); // Return the updated iterator
                     }
 
                     // Post-increment operator - returns current state before incrementing
-                    AscendingOrder operator++(int) {
-                        AscendingOrder temp = *this; // Create a copy of current state
+                    Derived operator++(int) {
+                        Derived temp = derived(); // Create a copy of current state
                         current_position++; // Increment current position
                         return temp; // Return the copy
                     }
 
-                    // Equal operator to compare iterators
-                    bool operator==(const AscendingOrder& other) const {
-                        return current_position == other.current_position; // Compare current positions of both iterators
+                    // Decrement operator - moves to previous element
+                    Derived& operator--() {
+                        current_position--; // Decrement current position
+                        return derived(); // Return the updated iterator
                     }
-                    
-                    // Not equal operator to compare iterators
-                    bool operator!=(const AscendingOrder& other) const {
-                        return current_position != other.current_position; // Compare current positions of both iterators
+
+                    // Post-decrement operator - returns current state before decrementing
+                    Derived operator--(int) {
+                        Derived temp = derived(); // Create a copy of current state
+                        current_position--; // Decrement current position
+                        return temp; // Return the copy
                     }
-            };
 
-            // Iterator for descending order
-            class DescendingOrder {
-                private:
-                    std::vector<size_t> sorted_indices; // Indices sorted by values
-                    size_t current_position; // Current position in indices
-                    const MyContainer<T>* container_ptr; // Pointer to original container
+                    // Compound assignment operators - move n positions at once
+                    Derived& operator+=(difference_type n) {
+                        current_position += n;
+                        return derived();
+                    }
 
-                    friend class MyContainer<T>; // To allow MyContainer to access private members
+                    Derived& operator-=(difference_type n) {
+                        current_position -= n;
+                        return derived();
+                    }
 
-                public:
-                    // Constructor - builds the sorted indices vector
-                    DescendingOrder(const MyContainer<T>& container) : container_ptr(&container), current_position(0) {
-                        // Create indices vector: [0, 1, 2, ...]
-                        sorted_indices.resize(container.data.size()); // Initialize with size of data
-                        std::iota(sorted_indices.begin(), sorted_indices.end(), 0); // Fill with indices [0, 1, 2, ...]
-                        
-                        // Sort indices by values in original container
-                        std::sort(sorted_indices.begin(), sorted_indices.end(),
-                                [&container](size_t a, size_t b) { return container.data[a] > container.data[b]; });
+                    // Arithmetic operators - iterator n positions away
+                    Derived operator+(difference_type n) const {
+                        Derived temp = derived();
+                        return temp += n;
                     }
 
-                    // Dereference operator - returns current element
-                    const T& operator*() const {
-                        size_t actual_index = sorted_indices[current_position]; // Get the actual index from sorted indices
-                        return container_ptr->data[actual_index]; // Return the element at that index
+                    friend Derived operator+(difference_type n, const Derived& it) {
+                        return it + n;
                     }
-                    
-                    // Increment operator - moves to next element
-                    DescendingOrder& operator++() {
-                        current_position++; // Increment current position
-                        return *this; // Return the updated iterator
+
+                    Derived operator-(difference_type n) const {
+                        Derived temp = derived();
+                        return temp -= n;
                     }
 
-                    // Post-increment operator - returns current state before incrementing
-                    DescendingOrder operator++(int) {
-                        DescendingOrder temp = *this; // Create a copy of current state
-                        current_position++; // Increment current position
-                        return temp; // Return the copy
+                    // Difference operator - number of positions between two iterators
+                    difference_type operator-(const Derived& other) const {
+                        return static_cast<difference_type>(current_position) - static_cast<difference_type>(other.current_position);
                     }
 
                     // Equal operator to compare iterators
-                    bool operator==(const DescendingOrder& other) const {
+                    bool operator==(const Derived& other) const {
                         return current_position == other.current_position; // Compare current positions of both iterators
                     }
                     
                     // Not equal operator to compare iterators
-                    bool operator!=(const DescendingOrder& other) const {
+                    bool operator!=(const Derived& other) const {
                         return current_position != other.current_position; // Compare current positions of both iterators
                     }
+
+                    // Ordering operators to compare iterators
+                    bool operator<(const Derived& other) const {
+                        return current_position < other.current_position;
+                    }
+
+                    bool operator>(const Derived& other) const {
+                        return current_position > other.current_position;
+                    }
+
+                    bool operator<=(const Derived& other) const {
+                        return current_position <= other.current_position;
+                    }
+
+                    bool operator>=(const Derived& other) const {
+                        return current_position >= other.current_position;
+                    }
             };
 
-            // Iterator for side-cross order
-            class SideCrossOrder {
+            // Iterator for ascending order
+            class AscendingOrder : public IteratorBase<AscendingOrder> {
                 private:
-                    std::vector<size_t> sorted_indices; // Indices sorted by values
-                    size_t current_position; // Current position in indices
-                    const MyContainer<T>* container_ptr; // Pointer to original container
+                    mutable std::shared_ptr<const IndexVector> sorted_indices; // Shared ascending permutation
+                    size_t top_k = std::numeric_limits<size_t>::max(); // k of a top-k end iterator (max = all elements)
 
-                    friend class MyContainer<T>; // To allow MyContainer to access private members
+                    friend class MyContainer; // To allow MyContainer to access private members
+                    friend class IteratorBase<AscendingOrder>; // To allow the base to call index_at
 
-                public:
-                    // Constructor - builds the sorted indices vector
-                    SideCrossOrder(const MyContainer<T>& container) : container_ptr(&container), current_position(0) {
-                        size_t size = container.data.size(); // Get size of the container
-                        if (size == 0) return; // Handle empty container
-
-                        // Temporary vector for sorting
-                        std::vector<size_t> temp_indices; // Temporary indices vector
-                        temp_indices.resize(container.data.size()); // Initialize with size of data
-                        std::iota(temp_indices.begin(), temp_indices.end(), 0); // Fill with indices [0, 1, 2, ...]
-                        
-                        // Sort indices by values in original container (ascending order)
-                        std::sort(temp_indices.begin(), temp_indices.end(),
-                                [&container](size_t a, size_t b) { return container.data[a] < container.data[b]; });
-                        
-                        // Create side-cross pattern
-                        sorted_indices.resize(container.data.size()); // Initialize with size of data
-                        size_t left = 0; // Start from the left
-                        size_t right = size - 1; // Start from the right
-                        size_t i = 0; // Index for sorted indices vector
-                        
-                        // Alternate between smallest and largest remaining elements
-                        while (left <= right) {
-                            // Take from left (smallest remaining)
-                            sorted_indices[i++] = temp_indices[left++];
-                            
-                            // Take from right (largest remaining) if we haven't crossed
-                            if (left <= right) {
-                                sorted_indices[i++] = temp_indices[right--];
-                            }
+                    // End constructor - only sets the position, so end iterators never allocate or sort
+                    AscendingOrder(const MyContainer& container, size_t position)
+                        : IteratorBase<AscendingOrder>(container, position) {}
+
+                    // Top-k end constructor - like the end constructor, but acquires the top-k permutation when used
+                    AscendingOrder(const MyContainer& container, size_t position, size_t k)
+                        : IteratorBase<AscendingOrder>(container, position), top_k(k) {}
+
+                    // Top-k constructor - walks a given (possibly partial) ascending permutation
+                    AscendingOrder(const MyContainer& container, std::shared_ptr<const IndexVector> permutation)
+                        : IteratorBase<AscendingOrder>(container, 0), sorted_indices(std::move(permutation)) {}
+
+                    // Shared permutation (end iterators acquire it on first use, e.g. when decremented)
+                    // A top-k end iterator only selects the k elements it can reach, it never sorts them all
+                    const IndexVector& permutation() const {
+                        if (!sorted_indices) {
+                            sorted_indices = top_k == std::numeric_limits<size_t>::max()
+                                ? this->container_ptr->sorted_permutation(IteratorKind::ascending)
+                                : this->container_ptr->top_k_permutation(top_k, false, IteratorKind::ascending);
                         }
+                        return *sorted_indices;
                     }
 
-                    // Dereference operator - returns current element
-                    const T& operator*() const {
-                        size_t actual_index = sorted_indices[current_position]; // Get the actual index from sorted indices
-                        return container_ptr->data[actual_index]; // Return the element at that index
+                    // Index in data visited at a given position (prefetches the element a few positions ahead)
+                    size_t index_at(size_t position) const {
+                        const IndexVector& ascending = permutation();
+                        this->container_ptr->prefetch_ahead(ascending, position, [](size_t p) { return p; });
+                        return ascending[position];
                     }
-                    
-                    // Increment operator - moves to next element
-                    SideCrossOrder& operator++() {
-                        current_position++; // Increment current position
-                        return *this; // Return the updated iterator
+
+                public:
+                    // Default constructor - singular iterator
+                    AscendingOrder() = default;
+
+                    // Constructor - takes the container's cached ascending permutation (sorts only if it is stale)
+                    AscendingOrder(const MyContainer& container)
+                        : IteratorBase<AscendingOrder>(container, 0), sorted_indices(container.sorted_permutation(IteratorKind::ascending)) {}
+            };
+
+            // Iterator for descending order
+            // A reverse view of the ascending permutation, so one sort serves both directions
+            // Equal elements are visited in reverse insertion order (the exact reverse of AscendingOrder, which keeps
+            // insertion order among equal elements)
+            class DescendingOrder : public IteratorBase<DescendingOrder> {
+                private:
+                    mutable std::shared_ptr<const IndexVector> sorted_indices; // Shared ascending permutation, walked backwards
+                    size_t top_k = std::numeric_limits<size_t>::max(); // k of a top-k end iterator (max = all elements)
+
+                    friend class MyContainer; // To allow MyContainer to access private members
+                    friend class IteratorBase<DescendingOrder>; // To allow the base to call index_at
+
+                    // End constructor - only sets the position, so end iterators never allocate or sort
+                    DescendingOrder(const MyContainer& container, size_t position)
+                        : IteratorBase<DescendingOrder>(container, position) {}
+
+                    // Top-k end constructor - like the end constructor, but acquires the top-k permutation when used
+                    DescendingOrder(const MyContainer& container, size_t position, size_t k)
+                        : IteratorBase<DescendingOrder>(container, position), top_k(k) {}
+
+                    // Top-k constructor - walks a given (possibly partial) ascending permutation
+                    DescendingOrder(const MyContainer& container, std::shared_ptr<const IndexVector> permutation)
+                        : IteratorBase<DescendingOrder>(container, 0), sorted_indices(std::move(permutation)) {}
+
+                    // Shared permutation (end iterators acquire it on first use, e.g. when decremented)
+                    // A top-k end iterator only selects the k elements it can reach, it never sorts them all
+                    const IndexVector& permutation() const {
+                        if (!sorted_indices) {
+                            sorted_indices = top_k == std::numeric_limits<size_t>::max()
+                                ? this->container_ptr->sorted_permutation(IteratorKind::descending)
+                                : this->container_ptr->top_k_permutation(top_k, true, IteratorKind::descending);
+                        }
+                        return *sorted_indices;
                     }
 
-                    // Post-increment operator - returns current state before incrementing
-                    SideCrossOrder operator++(int) {
-                        SideCrossOrder temp = *this; // Create a copy of current state
-                        current_position++; // Increment current position
-                        return temp; // Return the copy
+                    // Index in data visited at a given position (read the ascending permutation from its end)
+                    size_t index_at(size_t position) const {
+                        const IndexVector& ascending = permutation();
+                        size_t last = ascending.size() - 1;
+                        this->container_ptr->prefetch_ahead(ascending, position, [last](size_t p) { return last - p; });
+                        return ascending[last - position];
                     }
 
-                    // Equal operator to compare iterators
-                    bool operator==(const SideCrossOrder& other) const {
-                        return current_position == other.current_position; // Compare current positions of both iterators
+                public:
+                    // Default constructor - singular iterator
+                    DescendingOrder() = default;
+
+                    // Constructor - takes the container's cached ascending permutation (sorts only if it is stale)
+                    DescendingOrder(const MyContainer& container)
+                        : IteratorBase<DescendingOrder>(container, 0), sorted_indices(container.sorted_permutation(IteratorKind::descending)) {}
+            };
+
+            // Iterator for side-cross order
+            class SideCrossOrder : public IteratorBase<SideCrossOrder> {
+                private:
+                    mutable std::shared_ptr<const IndexVector> sorted_indices; // Shared ascending permutation, read from both ends
+
+                    friend class MyContainer; // To allow MyContainer to access private members
+                    friend class IteratorBase<SideCrossOrder>; // To allow the base to call index_at
+
+                    // End constructor - only sets the position, so end iterators never allocate or sort
+                    SideCrossOrder(const MyContainer& container, size_t position)
+                        : IteratorBase<SideCrossOrder>(container, position) {}
+
+                    // Shared permutation (end iterators acquire it on first use, e.g. when decremented)
+                    const IndexVector& permutation() const {
+                        if (!sorted_indices) {
+                            sorted_indices = this->container_ptr->sorted_permutation(IteratorKind::side_cross);
+                        }
+                        return *sorted_indices;
                     }
-                    
-                    // Not equal operator to compare iterators
-                    bool operator!=(const SideCrossOrder& other) const {
-                        return current_position != other.current_position; // Compare current positions of both iterators
+
+                    // Index in data visited at a given position
+                    // Even positions take the smallest remaining element, odd positions the largest:
+                    // asc[0], asc[n - 1], asc[1], asc[n - 2], ...
+                    size_t index_at(size_t position) const {
+                        const IndexVector& ascending = permutation();
+                        size_t last = ascending.size() - 1;
+                        auto slot = [last](size_t p) { return (p % 2 == 0) ? p / 2 : last - p / 2; }; // p / 2 taken from this end
+                        this->container_ptr->prefetch_ahead(ascending, position, slot);
+                        return ascending[slot(position)];
                     }
+
+                public:
+                    // Default constructor - singular iterator
+                    SideCrossOrder() = default;
+
+                    // Constructor - takes the container's cached ascending permutation (sorts only if it is stale)
+                    SideCrossOrder(const MyContainer& container)
+                        : IteratorBase<SideCrossOrder>(container, 0), sorted_indices(container.sorted_permutation(IteratorKind::side_cross)) {}
             };
 
             // Iterator for reverse order
-            class ReverseOrder {
+            class ReverseOrder : public IteratorBase<ReverseOrder> {
                 private:
-                    std::vector<size_t> sorted_indices; // Indices sorted by values
-                    size_t current_position; // Current position in indices
-                    const MyContainer<T>* container_ptr; // Pointer to original container
+                    size_t container_size = 0; // Number of elements when the iterator was created
 
-                    friend class MyContainer<T>; // To allow MyContainer to access private members
+                    friend class MyContainer; // To allow MyContainer to access private members
+                    friend class IteratorBase<ReverseOrder>; // To allow the base to call index_at
 
-                public:
-                    // Constructor - builds the sorted indices vector
-                    ReverseOrder(const MyContainer<T>& container) : container_ptr(&container), current_position(0) {
-                        // Create indices vector: [0, 1, 2, ...]
-                        sorted_indices.resize(container.data.size()); // Initialize with size of data
-                        std::iota(sorted_indices.begin(), sorted_indices.end(), 0); // Fill with indices [0, 1, 2, ...]
-                        std::reverse(sorted_indices.begin(), sorted_indices.end()); // => [..., 2, 1, 0] (Reverse)
-                    }
-                    
-                    // Dereference operator - returns current element
-                    const T& operator*() const {
-                        size_t actual_index = sorted_indices[current_position]; // Get the actual index from sorted indices
-                        return container_ptr->data[actual_index]; // Return the element at that index
+                    // End constructor - only sets the position, so end iterators never allocate or sort
+                    ReverseOrder(const MyContainer& container, size_t position)
+                        : IteratorBase<ReverseOrder>(container, position), container_size(container.data.size()) {}
+
+                    // Index in data visited at a given position (walk from the last index backwards)
+                    size_t index_at(size_t position) const {
+                        return container_size - 1 - position;
                     }
-                    
-                    // Increment operator - moves to next element
-                    ReverseOrder& operator++() {
-                        current_position++; // Increment current position
-                        return *this; // Return the updated iterator
+
+                public:
+                    // Default constructor - singular iterator
+                    ReverseOrder() = default;
+
+                    // Constructor - no index vector, position p maps to index (size - 1 - p)
+                    ReverseOrder(const MyContainer& container)
+                        : IteratorBase<ReverseOrder>(container, 0), container_size(container.data.size()) {}
+            };
+
+            // Iterator for regular order
+            class Order : public IteratorBase<Order> {
+                private:
+                    friend class MyContainer; // To allow MyContainer to access private members
+                    friend class IteratorBase<Order>; // To allow the base to call index_at
+
+                    // End constructor - only sets the position, so end iterators never allocate or sort
+                    Order(const MyContainer& container, size_t position)
+                        : IteratorBase<Order>(container, position) {}
+
+                    // Index in data visited at a given position (position and index are the same)
+                    size_t index_at(size_t position) const {
+                        return position;
                     }
 
-                    // Post-increment operator - returns current state before incrementing
-                    ReverseOrder operator++(int) {
-                        ReverseOrder temp = *this; // Create a copy of current state
-                        current_position++; // Increment current position
-                        return temp; // Return the copy
+                public:
+                    // Default constructor - singular iterator
+                    Order() = default;
+
+                    // Constructor - no index vector, position p maps to index p
+                    Order(const MyContainer& container) : IteratorBase<Order>(container, 0) {}
+            };
+
+            // Iterator for middle-out order
+            class MiddleOutOrder : public IteratorBase<MiddleOutOrder> {
+                private:
+                    size_t middle = 0; // Index of the middle element when the iterator was created
+
+                    friend class MyContainer; // To allow MyContainer to access private members
+                    friend class IteratorBase<MiddleOutOrder>; // To allow the base to call index_at
+
+                    // End constructor - only sets the position, so end iterators never allocate or sort
+                    MiddleOutOrder(const MyContainer& container, size_t position)
+                        : IteratorBase<MiddleOutOrder>(container, position), middle(container.data.size() / 2) {}
+
+                    // Index in data visited at a given position
+                    size_t index_at(size_t position) const {
+                        // Position 0 is the middle, odd positions step left and even positions step right:
+                        // mid, mid - 1, mid + 1, mid - 2, mid + 2, ...
+                        // The left side is never shorter than the right, so the pattern holds up to the last element
+                        size_t offset = (position + 1) / 2; // Distance from the middle
+                        return (position % 2 == 1) ? middle - offset : middle + offset;
                     }
 
-                    // Equal operator to compare iterators
-                    bool operator==(const ReverseOrder& other) const {
-                        return current_position == other.current_position; // Compare current positions of both iterators
+                public:
+                    // Default constructor - singular iterator
+                    MiddleOutOrder() = default;
+
+                    // Constructor - no index vector, positions alternate around the middle index
+                    MiddleOutOrder(const MyContainer& container)
+                        : IteratorBase<MiddleOutOrder>(container, 0), middle(container.data.size() / 2) {}
+            };
+
+            // Iterator for ascending order that sorts incrementally (incremental quicksort)
+            // Copies share the sorting progress, so reading the first m elements costs O(n + m log m)
+            class LazyAscendingOrder : public IteratorBase<LazyAscendingOrder> {
+                private:
+                    mutable std::shared_ptr<LazySort> state; // Shared incremental sort
+
+                    friend class MyContainer; // To allow MyContainer to access private members
+                    friend class IteratorBase<LazyAscendingOrder>; // To allow the base to call index_at
+
+                    // End constructor - only sets the position, so end iterators never allocate or sort
+                    LazyAscendingOrder(const MyContainer& container, size_t position)
+                        : IteratorBase<LazyAscendingOrder>(container, position) {}
+
+                    // Index in data visited at a given position (sorts just far enough to make it final)
+                    size_t index_at(size_t position) const {
+                        if (!state) {
+                            state = this->container_ptr->lazy_sort_state(false, IteratorKind::ascending);
+                        }
+                        return this->container_ptr->lazy_sorted_permutation(*state, position, false)[position];
                     }
-                    
-                    // Not equal operator to compare iterators
-                    bool operator!=(const ReverseOrder& other) const {
-                        return current_position != other.current_position; // Compare current positions of both iterators
+
+                public:
+                    // Default constructor - singular iterator
+                    LazyAscendingOrder() = default;
+
+                    // Constructor - starts the incremental sort (or reuses an up-to-date cached permutation)
+                    LazyAscendingOrder(const MyContainer& container)
+                        : IteratorBase<LazyAscendingOrder>(container, 0), state(container.lazy_sort_state(false, IteratorKind::ascending)) {}
+            };
+
+            // Iterator for descending order that sorts incrementally (incremental quicksort from the largest end)
+            // Copies share the sorting progress, so reading the first m elements costs O(n + m log m)
+            class LazyDescendingOrder : public IteratorBase<LazyDescendingOrder> {
+                private:
+                    mutable std::shared_ptr<LazySort> state; // Shared incremental sort
+
+                    friend class MyContainer; // To allow MyContainer to access private members
+                    friend class IteratorBase<LazyDescendingOrder>; // To allow the base to call index_at
+
+                    // End constructor - only sets the position, so end iterators never allocate or sort
+                    LazyDescendingOrder(const MyContainer& container, size_t position)
+                        : IteratorBase<LazyDescendingOrder>(container, position) {}
+
+                    // Index in data visited at a given position (read the ascending permutation from its end)
+                    size_t index_at(size_t position) const {
+                        if (!state) {
+                            state = this->container_ptr->lazy_sort_state(true, IteratorKind::descending);
+                        }
+                        const IndexVector& ascending = this->container_ptr->lazy_sorted_permutation(*state, position, true);
+                        return ascending[ascending.size() - 1 - position];
                     }
+
+                public:
+                    // Default constructor - singular iterator
+                    LazyDescendingOrder() = default;
+
+                    // Constructor - starts the incremental sort (or reuses an up-to-date cached permutation)
+                    LazyDescendingOrder(const MyContainer& container)
+                        : IteratorBase<LazyDescendingOrder>(container, 0), state(container.lazy_sort_state(true, IteratorKind::descending)) {}
             };
 
-            // Iterator for regular order
-            class Order {
+            // Immutable sorted copy of the elements (see sorted_snapshot)
+            // Copies share the values, which stay valid after the container changes or is destroyed
+            class SortedSnapshot {
                 private:
-                    std::vector<size_t> sorted_indices; // Indices sorted by values
-                    size_t current_position; // Current position in indices
-                    const MyContainer<T>* container_ptr; // Pointer to original container
+                    using Values = std::vector<T, Alloc>;
+                    std::shared_ptr<const Values> values; // Elements in ascending order
 
-                    friend class MyContainer<T>; // To allow MyContainer to access private members
+                    friend class MyContainer; // To allow MyContainer to create snapshots
+
+                    // Constructor - wraps the container's shared sorted copy
+                    explicit SortedSnapshot(std::shared_ptr<const Values> values) : values(std::move(values)) {}
 
                 public:
-                    // Constructor - builds the sorted indices vector
-                    Order(const MyContainer<T>& container) : container_ptr(&container), current_position(0) {
-                        // Create indices vector: [0, 1, 2, ...]
-                        sorted_indices.resize(container.data.size()); // Initialize with size of data
-                        std::iota(sorted_indices.begin(), sorted_indices.end(), 0); // Fill with indices [0, 1, 2, ...]
-                    }
-                    
-                    // Dereference operator - returns current element
-                    const T& operator*() const {
-                        size_t actual_index = sorted_indices[current_position];
-                        return container_ptr->data[actual_index];
-                    }
-                    
-                    // Increment operator - moves to next element
-                    Order& operator++() {
-                        current_position++; // Increment current position
-                        return *this; // Return the updated iterator
+                    class SideCrossIterator; // Iterator alternating between the smallest and the largest remaining element
+
+                    using const_iterator = typename Values::const_iterator;
+                    using const_reverse_iterator = typename Values::const_reverse_iterator;
+
+                    // Return number of elements in the snapshot
+                    size_t size() const {
+                        return values->size();
                     }
 
-                    // Post-increment operator - returns current state before incrementing
-                    Order operator++(int) {
-                        Order temp = *this; // Create a copy of current state
-                        current_position++; // Increment current position
-                        return temp; // Return the copy
+                    // Return true if the snapshot has no elements
+                    bool empty() const {
+                        return values->empty();
                     }
 
-                    // Equal operator to compare iterators
-                    bool operator==(const Order& other) const {
-                        return current_position == other.current_position; // Compare current positions of both iterators
+                    // Return the i-th smallest element
+                    const T& operator[](size_t i) const {
+                        return (*values)[i];
                     }
-                    
-                    // Not equal operator to compare iterators
-                    bool operator!=(const Order& other) const {
-                        return current_position != other.current_position; // Compare current positions of both iterators
+
+                    // Return a pointer to the contiguous sorted elements
+                    const T* data() const {
+                        return values->data();
                     }
-            };
 
-            // Iterator for middle-out order
-            class MiddleOutOrder {
-                private:
-                    std::vector<size_t> sorted_indices; // Indices sorted by values
-                    size_t current_position; // Current position in indices
-                    const MyContainer<T>* container_ptr; // Pointer to original container
+                    // Ascending order - a plain forward scan
+                    const_iterator begin_ascending_order() const {
+                        return values->begin();
+                    }
 
-                    friend class MyContainer<T>; // To allow MyContainer to access private members
+                    const_iterator end_ascending_order() const {
+                        return values->end();
+                    }
 
-                public:
-                    // Constructor - builds the sorted indices vector
-                    MiddleOutOrder(const MyContainer<T>& container) : container_ptr(&container), current_position(0) {
-                        size_t size = container.data.size(); // Get size of the container
-                        if (size == 0) return;  // In case of empty container
-                        
-                        sorted_indices.resize(size); // Initialize with size of data
-                        size_t mid = size / 2;  // Find middle index
-                        size_t i = 0; // Index for sorted indices vector
-                        
-                        sorted_indices[i++] = mid; // Start with middle element
-                        
-                        // Alternate between left and right of middle
-                        for (size_t offset = 1; offset <= mid; ++offset) {
-                            // Add element to the left of middle (if exists)
-                            if (mid >= offset) {
-                                sorted_indices[i++] = mid - offset;
-                            }
-                            
-                            // Add element to the right of middle (if exists)
-                            if (mid + offset < size) {
-                                sorted_indices[i++] = mid + offset;
-                            }
-                        }
+                    // Descending order - a plain backward scan
+                    const_reverse_iterator begin_descending_order() const {
+                        return values->rbegin();
                     }
 
-                    // Dereference operator - returns current element
-                    const T& operator*() const {
-                        size_t actual_index = sorted_indices[current_position]; // Get the actual index from sorted indices
-                        return container_ptr->data[actual_index]; // Return the element at that index
+                    const_reverse_iterator end_descending_order() const {
+                        return values->rend();
                     }
-                    
-                    // Increment operator - moves to next element
-                    MiddleOutOrder& operator++() {
-                        current_position++; // Increment current position
-                        return *this; // Return the updated iterator
+
+                    // Side-cross order - two sequential scans, one from each end
+                    SideCrossIterator begin_side_cross_order() const {
+                        return SideCrossIterator(values->data(), values->size(), 0);
                     }
 
-                    // Post-increment operator - returns current state before incrementing
-                    MiddleOutOrder operator++(int) {
-                        MiddleOutOrder temp = *this; // Create a copy of current state
-                        current_position++; // Increment current position
-                        return temp; // Return the copy
+                    SideCrossIterator end_side_cross_order() const {
+                        return SideCrossIterator(values->data(), values->size(), values->size());
                     }
 
-                    // Equal operator to compare iterators
-                    bool operator==(const MiddleOutOrder& other) const {
-                        return current_position == other.current_position; // Compare current positions of both iterators
+                    // Range-based for loops visit the snapshot in ascending order
+                    const_iterator begin() const {
+                        return begin_ascending_order();
                     }
-                    
-                    // Not equal operator to compare iterators
-                    bool operator!=(const MiddleOutOrder& other) const {
-                        return current_position != other.current_position; // Compare current positions of both iterators
+
+                    const_iterator end() const {
+                        return end_ascending_order();
                     }
+
+                    // Iterator for side-cross order over the sorted copy: positions 0, n - 1, 1, n - 2, ...
+                    class SideCrossIterator {
+                        private:
+                            const T* first = nullptr; // Smallest element of the snapshot
+                            size_t last = 0; // Offset of the largest element (size - 1)
+                            size_t current_position = 0; // Current position in the traversal
+
+                        public:
+                            // Iterator traits (used by std::iterator_traits)
+                            using iterator_category = std::random_access_iterator_tag;
+                            using value_type = T;
+                            using difference_type = std::ptrdiff_t;
+                            using pointer = const T*;
+                            using reference = const T&;
+
+                            // Default constructor - singular iterator
+                            SideCrossIterator() = default;
+
+                            // Constructor - iterator at a position over size sorted elements starting at first
+                            SideCrossIterator(const T* first, size_t size, size_t position)
+                                : first(first), last(size - 1), current_position(position) {}
+
+                            // Dereference operator - even positions read from the front, odd ones from the back
+                            reference operator*() const {
+                                return (*this)[0];
+                            }
+
+                            pointer operator->() const {
+                                return &**this;
+                            }
+
+                            reference operator[](difference_type n) const {
+                                size_t position = current_position + n;
+                                return first[(position % 2 == 0) ? position / 2 : last - position / 2];
+                            }
+
+                            // Increment and decrement operators
+                            SideCrossIterator& operator++() {
+                                current_position++;
+                                return *this;
+                            }
+
+                            SideCrossIterator operator++(int) {
+                                SideCrossIterator temp = *this;
+                                current_position++;
+                                return temp;
+                            }
+
+                            SideCrossIterator& operator--() {
+                                current_position--;
+                                return *this;
+                            }
+
+                            SideCrossIterator operator--(int) {
+                                SideCrossIterator temp = *this;
+                                current_position--;
+                                return temp;
+                            }
+
+                            // Compound assignment and arithmetic operators - move n positions at once
+                            SideCrossIterator& operator+=(difference_type n) {
+                                current_position += n;
+                                return *this;
+                            }
+
+                            SideCrossIterator& operator-=(difference_type n) {
+                                current_position -= n;
+                                return *this;
+                            }
+
+                            SideCrossIterator operator+(difference_type n) const {
+                                SideCrossIterator temp = *this;
+                                return temp += n;
+                            }
+
+                            friend SideCrossIterator operator+(difference_type n, const SideCrossIterator& it) {
+                                return it + n;
+                            }
+
+                            SideCrossIterator operator-(difference_type n) const {
+                                SideCrossIterator temp = *this;
+                                return temp -= n;
+                            }
+
+                            difference_type operator-(const SideCrossIterator& other) const {
+                                return static_cast<difference_type>(current_position) - static_cast<difference_type>(other.current_position);
+                            }
+
+                            // Comparison operators - compare positions
+                            bool operator==(const SideCrossIterator& other) const {
+                                return current_position == other.current_position;
+                            }
+
+                            bool operator!=(const SideCrossIterator& other) const {
+                                return current_position != other.current_position;
+                            }
+
+                            bool operator<(const SideCrossIterator& other) const {
+                                return current_position < other.current_position;
+                            }
+
+                            bool operator>(const SideCrossIterator& other) const {
+                                return current_position > other.current_position;
+                            }
+
+                            bool operator<=(const SideCrossIterator& other) const {
+                                return current_position <= other.current_position;
+                            }
+
+                            bool operator>=(const SideCrossIterator& other) const {
+                                return current_position >= other.current_position;
+                            }
+                    };
             };
 
     }; // End of MyContainer class
 
-    template <typename T> // Template declaration
+    template <typename T, typename Alloc, typename Index> // Template declaration
 
     // Output operator (friend function)
-    std::ostream& operator<<(std::ostream& os, const MyContainer<T>& container) {
+    std::ostream& operator<<(std::ostream& os, const MyContainer<T, Alloc, Index>& container) {
         os << "["; // Start output with an opening bracket
 
         // Iterate through the elements and output them
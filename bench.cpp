@@ -0,0 +1,266 @@
+// Email: razcohenp@gmail.com
+// Micro-benchmarks for MyContainer (google-benchmark style output, no external dependencies)
+// Usage: ./benchmark [max_size] [min_seconds]   (defaults: 10000000 and 0.1)
+#include "MyContainer.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+
+using namespace my_container; // Use the my_container namespace
+
+// Allocation counting - every global operator new bumps the counter
+static size_t allocation_count = 0;
+
+// new and delete are not inlined, so GCC never pairs malloc with operator delete or operator new with free
+// (-Wmismatched-new-delete)
+[[gnu::noinline]] void* operator new(size_t size) {
+    ++allocation_count;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+[[gnu::noinline]] void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    operator delete[](ptr);
+}
+
+namespace {
+    double min_seconds = 0.1; // Minimal measured time per benchmark
+    volatile size_t sink = 0; // Keeps traversals from being optimised away
+
+    // Result of one benchmark
+    struct Result {
+        double ns_per_element; // Measured time divided by the number of elements
+        double allocations_per_op; // Heap allocations per run of the body
+        size_t iterations; // Number of measured runs
+    };
+
+    // Run setup() untimed and body() timed until min_seconds of body time was collected
+    template <typename Setup, typename Body>
+    Result measure(size_t n, Setup setup, Body body) {
+        using clock = std::chrono::steady_clock;
+        std::chrono::nanoseconds total(0); // Total time spent in body
+        size_t allocations = 0; // Total allocations made by body
+        size_t iterations = 0; // Number of runs
+
+        while (total < std::chrono::duration<double>(min_seconds) || iterations == 0) {
+            setup();
+
+            size_t allocations_before = allocation_count;
+            auto start = clock::now();
+            body();
+            auto stop = clock::now();
+
+            allocations += allocation_count - allocations_before;
+            total += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+            ++iterations;
+        }
+
+        return Result{static_cast<double>(total.count()) / static_cast<double>(iterations * n),
+                      static_cast<double>(allocations) / static_cast<double>(iterations), iterations};
+    }
+
+    // Print one result line
+    void report(const char* type_name, const char* benchmark, size_t n, const Result& result) {
+        std::string name = std::string(type_name) + "/" + benchmark;
+        std::printf("%-34s %10zu %12.2f %12.2f %10zu\n", name.c_str(), n, result.ns_per_element,
+                    result.allocations_per_op, result.iterations);
+    }
+
+    // Value generators for each benchmarked type
+    template <typename T>
+    T make_value(std::mt19937& rng);
+
+    template <>
+    int make_value<int>(std::mt19937& rng) {
+        return static_cast<int>(rng());
+    }
+
+    template <>
+    double make_value<double>(std::mt19937& rng) {
+        return std::uniform_real_distribution<double>(-1e9, 1e9)(rng);
+    }
+
+    template <>
+    std::string make_value<std::string>(std::mt19937& rng) {
+        return "key-" + std::to_string(rng()); // Mix of short and heap-allocated strings
+    }
+
+    // Sum of the elements reached by a traversal (keeps the loop observable)
+    size_t weight(int value) { return static_cast<size_t>(value); }
+    size_t weight(double value) { return static_cast<size_t>(value); }
+    size_t weight(const std::string& value) { return value.size(); }
+
+    // Full traversal from a begin iterator to an end iterator
+    template <typename Iterator>
+    void traverse(Iterator it, Iterator end) {
+        size_t total = 0;
+        for (; it != end; ++it) {
+            total += weight(*it);
+        }
+        sink = sink + total;
+    }
+
+    // Benchmark construction plus full traversal of one order, once on a fresh container and once cached
+    template <typename T, typename Begin, typename End>
+    void bench_order(const char* type_name, const char* cold_name, const char* warm_name,
+                     const std::vector<T>& values, Begin begin, End end) {
+        size_t n = values.size();
+        MyContainer<T> c; // Rebuilt before every cold run, so no cached permutation exists
+
+        report(type_name, cold_name, n, measure(n,
+            [&c, &values]() { c = MyContainer<T>(); c.append_range(values.begin(), values.end()); },
+            [&c, &begin, &end]() { traverse(begin(c), end(c)); }));
+
+        if (warm_name != nullptr) {
+            report(type_name, warm_name, n, measure(n, []() {}, [&c, &begin, &end]() { traverse(begin(c), end(c)); }));
+        }
+    }
+
+    // Benchmark building the sorted permutation with one sort strategy (plus a full ascending traversal)
+    template <typename T>
+    void bench_strategy(const char* type_name, const char* name, const std::vector<T>& values, SortStrategy strategy) {
+        size_t n = values.size();
+        MyContainer<T> c; // Rebuilt before every run, so no cached permutation exists
+
+        report(type_name, name, n, measure(n,
+            [&c, &values, strategy]() {
+                c = MyContainer<T>();
+                c.set_sort_strategy(strategy);
+                c.append_range(values.begin(), values.end());
+            },
+            [&c]() { traverse(c.begin_ascending_order(), c.end_ascending_order()); }));
+    }
+
+    // All benchmarks for one element type and size
+    template <typename T>
+    void bench_type(const char* type_name, size_t n) {
+        std::mt19937 rng(12345); // Fixed seed, same data for every run
+        std::vector<T> values(n);
+        for (T& value : values) {
+            value = make_value<T>(rng);
+        }
+
+        // add: one call per element into an empty container
+        report(type_name, "add", n, measure(n, []() {}, [&values]() {
+            MyContainer<T> c;
+            for (const T& value : values) {
+                c.add(value);
+            }
+            sink = sink + c.size();
+        }));
+
+        // append_range: one bulk insertion
+        report(type_name, "append_range", n, measure(n, []() {}, [&values]() {
+            MyContainer<T> c;
+            c.append_range(values.begin(), values.end());
+            sink = sink + c.size();
+        }));
+
+        // remove: every 8th element holds the removed value
+        T removed = values[0];
+        std::vector<T> with_duplicates(values);
+        for (size_t i = 0; i < n; i += 8) {
+            with_duplicates[i] = removed;
+        }
+        MyContainer<T> c;
+        report(type_name, "remove", n, measure(n,
+            [&c, &with_duplicates]() { c = MyContainer<T>(); c.append_range(with_duplicates.begin(), with_duplicates.end()); },
+            [&c, &removed]() { c.remove(removed); }));
+
+        // Every traversal order (sorted ones also measured with the permutation already cached)
+        bench_order(type_name, "ascending", "ascending/cached", values,
+            [](const MyContainer<T>& c) { return c.begin_ascending_order(); },
+            [](const MyContainer<T>& c) { return c.end_ascending_order(); });
+
+        // Each sort strategy on its own (radix only applies to arithmetic types)
+        bench_strategy(type_name, "ascending/indirect", values, SortStrategy::indirect);
+        bench_strategy(type_name, "ascending/decorated", values, SortStrategy::decorated);
+        if (std::is_arithmetic<T>::value) {
+            bench_strategy(type_name, "ascending/radix", values, SortStrategy::radix);
+        }
+
+        // Batch traversal of the cached ascending order through for_each_chunk
+        MyContainer<T> chunked;
+        chunked.append_range(values.begin(), values.end());
+        traverse(chunked.begin_ascending_order(), chunked.end_ascending_order()); // Build the permutation
+        report(type_name, "ascending/chunked", n, measure(n, []() {}, [&chunked]() {
+            size_t total = 0;
+            chunked.for_each_chunk(IteratorKind::ascending, 256, [&total](const T* chunk, size_t count) {
+                for (size_t i = 0; i < count; ++i) {
+                    total += weight(chunk[i]);
+                }
+            });
+            sink = sink + total;
+        }));
+
+        // Scan of the materialised sorted copy (built once, outside the measurement)
+        auto snapshot = chunked.sorted_snapshot();
+        report(type_name, "ascending/snapshot", n, measure(n, []() {}, [&snapshot]() {
+            traverse(snapshot.begin_ascending_order(), snapshot.end_ascending_order());
+        }));
+
+        bench_order(type_name, "lazy_ascending", nullptr, values,
+            [](const MyContainer<T>& c) { return c.begin_lazy_ascending_order(); },
+            [](const MyContainer<T>& c) { return c.end_lazy_ascending_order(); });
+
+        bench_order(type_name, "descending", "descending/cached", values,
+            [](const MyContainer<T>& c) { return c.begin_descending_order(); },
+            [](const MyContainer<T>& c) { return c.end_descending_order(); });
+        bench_order(type_name, "side_cross", "side_cross/cached", values,
+            [](const MyContainer<T>& c) { return c.begin_side_cross_order(); },
+            [](const MyContainer<T>& c) { return c.end_side_cross_order(); });
+        bench_order(type_name, "reverse", nullptr, values,
+            [](const MyContainer<T>& c) { return c.begin_reverse_order(); },
+            [](const MyContainer<T>& c) { return c.end_reverse_order(); });
+        bench_order(type_name, "order", nullptr, values,
+            [](const MyContainer<T>& c) { return c.begin_order(); },
+            [](const MyContainer<T>& c) { return c.end_order(); });
+        bench_order(type_name, "middle_out", nullptr, values,
+            [](const MyContainer<T>& c) { return c.begin_middle_out_order(); },
+            [](const MyContainer<T>& c) { return c.end_middle_out_order(); });
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t max_size = 10000000; // Largest container size (10^7)
+    if (argc > 1) {
+        max_size = std::strtoull(argv[1], nullptr, 10);
+    }
+    if (argc > 2) {
+        min_seconds = std::strtod(argv[2], nullptr);
+    }
+
+    std::printf("%-34s %10s %12s %12s %10s\n", "Benchmark", "n", "ns/element", "allocs/op", "iterations");
+    std::printf("%s\n", std::string(82, '-').c_str());
+
+    // Sizes 10, 100, ..., max_size
+    for (size_t n = 10; n <= max_size; n *= 10) {
+        bench_type<int>("int", n);
+        bench_type<double>("double", n);
+        bench_type<std::string>("string", n);
+    }
+
+    return 0;
+}
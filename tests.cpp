@@ -1,10 +1,86 @@
 // Email: razcohenp@gmail.com
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
+#define MYCONTAINER_ENABLE_STATS // Tests also cover the activity counters
 #include "MyContainer.hpp"
+#include "MonotonicArena.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
 
 using namespace my_container;
 
+// Allocation counting - every global operator new bumps the counter (checks that arena-backed work stays off the heap)
+static std::atomic<size_t> global_allocations{0};
+
+// new and delete are not inlined, so GCC never pairs malloc with operator delete or operator new with free
+// (-Wmismatched-new-delete)
+[[gnu::noinline]] void* operator new(size_t size) {
+    ++global_allocations;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+[[gnu::noinline]] void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    operator delete[](ptr);
+}
+
+// Element compared by key only, the tag tells apart elements with equal keys
+struct Tagged {
+    int key;
+    int tag;
+
+    bool operator<(const Tagged& other) const { return key < other.key; }
+    bool operator==(const Tagged& other) const { return key == other.key; }
+};
+
+// Allocator tracking the bytes it currently has handed out (shared by all rebound copies)
+template <typename T>
+struct LiveBytesAllocator {
+    using value_type = T;
+    long long* live; // Bytes allocated and not yet deallocated
+
+    explicit LiveBytesAllocator(long long* live) : live(live) {}
+
+    template <typename U>
+    LiveBytesAllocator(const LiveBytesAllocator<U>& other) : live(other.live) {}
+
+    T* allocate(size_t n) {
+        *live += static_cast<long long>(n * sizeof(T));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        *live -= static_cast<long long>(n * sizeof(T));
+        ::operator delete(ptr);
+    }
+
+    template <typename U>
+    bool operator==(const LiveBytesAllocator<U>& other) const { return live == other.live; }
+
+    template <typename U>
+    bool operator!=(const LiveBytesAllocator<U>& other) const { return live != other.live; }
+};
+
 TEST_CASE("MyContainer and Iterators - basic functionality") {
     MyContainer<> c;  // Create an instance of MyContainer with default type (should be int)
 
@@ -593,3 +669,1169 @@ TEST_CASE("DescendingOrder with doubles including negative numbers") {
 
     CHECK(result == std::vector<double>({2.2, 0.1, -4.5})); // Check if the result matches the expected order
 }
+
+TEST_CASE("Sorted iterators follow changes to the container") {
+    MyContainer<int> c; // Create an instance of MyContainer with int type
+
+    // Add elements to the container
+    c.add(5);
+    c.add(3);
+    c.add(8);
+
+    std::vector<int> result; // Collect results in a vector
+
+    // First traversal builds the sorted permutation
+    for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it) {
+        result.push_back(*it);
+    }
+    CHECK(result == std::vector<int>({3, 5, 8}));
+
+    // Second traversal of the unchanged container reuses it
+    result.clear();
+    for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it) {
+        result.push_back(*it);
+    }
+    CHECK(result == std::vector<int>({3, 5, 8}));
+
+    c.add(1); // Adding must invalidate the cached permutation
+    result.clear();
+    for (auto it = c.begin_descending_order(); it != c.end_descending_order(); ++it) {
+        result.push_back(*it);
+    }
+    CHECK(result == std::vector<int>({8, 5, 3, 1}));
+
+    c.remove(5); // Removing must invalidate it as well
+    result.clear();
+    for (auto it = c.begin_side_cross_order(); it != c.end_side_cross_order(); ++it) {
+        result.push_back(*it);
+    }
+    CHECK(result == std::vector<int>({1, 8, 3}));
+}
+
+TEST_CASE("End iterators mark the position after the last element") {
+    MyContainer<int> c; // Create an instance of MyContainer with int type
+
+    // Add elements to the container
+    c.add(3);
+    c.add(1);
+    c.add(2);
+
+    // Advancing each begin iterator size() times must reach its end iterator
+    auto asc = c.begin_ascending_order();
+    auto desc = c.begin_descending_order();
+    auto cross = c.begin_side_cross_order();
+    auto rev = c.begin_reverse_order();
+    auto ord = c.begin_order();
+    auto mid = c.begin_middle_out_order();
+
+    for (size_t i = 0; i < c.size(); ++i) {
+        CHECK(asc != c.end_ascending_order());
+        CHECK(mid != c.end_middle_out_order());
+        ++asc; ++desc; ++cross; ++rev; ++ord; ++mid;
+    }
+
+    CHECK(asc == c.end_ascending_order());
+    CHECK(desc == c.end_descending_order());
+    CHECK(cross == c.end_side_cross_order());
+    CHECK(rev == c.end_reverse_order());
+    CHECK(ord == c.end_order());
+    CHECK(mid == c.end_middle_out_order());
+}
+
+TEST_CASE("MyContainer - remove_if and remove_all") {
+    MyContainer<int> c; // Create an instance of MyContainer with int type
+
+    // Add elements to the container
+    c.add(1);
+    c.add(2);
+    c.add(3);
+    c.add(2);
+    c.add(4);
+    c.add(5);
+
+    SUBCASE("remove_if removes every matching element and keeps the order") {
+        c.remove_if([](int value) { return value % 2 == 0; }); // Remove even numbers
+
+        std::stringstream out;
+        out << c;
+        CHECK(out.str() == "[1, 3, 5]"); // Survivors keep their insertion order
+        CHECK_THROWS(c.remove_if([](int value) { return value % 2 == 0; })); // Nothing left to remove
+    }
+
+    SUBCASE("remove_all removes every occurrence of every value") {
+        c.remove_all(std::vector<int>({2, 5, 42})); // 42 is not in the container
+
+        std::stringstream out;
+        out << c;
+        CHECK(out.str() == "[1, 3, 4]");
+        CHECK_THROWS(c.remove_all(std::vector<int>({2, 5}))); // Already removed
+        CHECK_THROWS(c.remove_all(std::vector<int>())); // Empty range removes nothing
+    }
+
+    SUBCASE("remove_all on a type without std::hash") {
+        MyContainer<std::pair<int, int>> pairs; // std::pair has no std::hash, so a sorted probe set is used
+
+        // Add elements to the container
+        pairs.add({1, 1});
+        pairs.add({2, 2});
+        pairs.add({1, 1});
+
+        pairs.remove_all(std::vector<std::pair<int, int>>({{1, 1}}));
+        CHECK(pairs.size() == 1);
+        CHECK(*pairs.begin_order() == std::make_pair(2, 2));
+    }
+}
+
+TEST_CASE("MyContainer - move-aware insertion and bulk append") {
+    SUBCASE("add(T&&) moves the element in") {
+        MyContainer<std::string> c; // Create an instance of MyContainer with string type
+        std::string value(100, 'x'); // Long enough to live on the heap
+
+        c.add(std::move(value)); // Move the string into the container
+        CHECK(c.size() == 1);
+        CHECK(*c.begin_order() == std::string(100, 'x'));
+    }
+
+    SUBCASE("emplace constructs the element in place") {
+        MyContainer<std::string> c; // Create an instance of MyContainer with string type
+        c.emplace(3, 'a'); // std::string(3, 'a')
+        CHECK(*c.begin_order() == "aaa");
+    }
+
+    SUBCASE("append_range reserves once and keeps the order") {
+        MyContainer<int> c; // Create an instance of MyContainer with int type
+        c.add(0);
+
+        std::vector<int> values({3, 1, 2});
+        c.append_range(values.begin(), values.end());
+        CHECK(c.size() == 4);
+        CHECK(c.capacity() >= 4); // Grown to fit the whole range
+
+        std::vector<int> result; // Collect results in a vector
+        for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it) {
+            result.push_back(*it);
+        }
+        CHECK(result == std::vector<int>({0, 1, 2, 3})); // Appended elements are seen by sorted iterators
+    }
+
+    SUBCASE("reserve and shrink_to_fit") {
+        MyContainer<int> c; // Create an instance of MyContainer with int type
+        c.reserve(50);
+        CHECK(c.capacity() >= 50);
+        CHECK(c.size() == 0);
+
+        c.add(1);
+        c.shrink_to_fit();
+        CHECK(c.size() == 1);
+    }
+}
+
+TEST_CASE("Index-free iterators match the expected order for many sizes") {
+    for (int n = 0; n <= 9; ++n) {
+        MyContainer<int> c; // Create an instance of MyContainer with int type
+        for (int i = 0; i < n; ++i) {
+            c.add(i); // Element value equals its index
+        }
+
+        // Expected middle-out order: middle, then alternate left and right
+        std::vector<int> expected_middle_out;
+        if (n > 0) {
+            int mid = n / 2;
+            expected_middle_out.push_back(mid);
+            for (int offset = 1; offset <= mid; ++offset) {
+                expected_middle_out.push_back(mid - offset);
+                if (mid + offset < n) {
+                    expected_middle_out.push_back(mid + offset);
+                }
+            }
+        }
+
+        std::vector<int> order, reverse, middle_out; // Collect results in vectors
+        for (auto it = c.begin_order(); it != c.end_order(); ++it) {
+            order.push_back(*it);
+        }
+        for (auto it = c.begin_reverse_order(); it != c.end_reverse_order(); ++it) {
+            reverse.push_back(*it);
+        }
+        for (auto it = c.begin_middle_out_order(); it != c.end_middle_out_order(); ++it) {
+            middle_out.push_back(*it);
+        }
+
+        std::vector<int> expected_order(n);
+        std::iota(expected_order.begin(), expected_order.end(), 0);
+        std::vector<int> expected_reverse(expected_order.rbegin(), expected_order.rend());
+
+        CHECK(order == expected_order);
+        CHECK(reverse == expected_reverse);
+        CHECK(middle_out == expected_middle_out);
+    }
+}
+
+TEST_CASE("Iterators are random access and work with standard algorithms") {
+    using Traits = std::iterator_traits<MyContainer<int>::AscendingOrder>; // Traits of one of the iterators
+    CHECK(std::is_same<Traits::iterator_category, std::random_access_iterator_tag>::value);
+    CHECK(std::is_same<Traits::value_type, int>::value);
+    CHECK(std::is_same<Traits::difference_type, std::ptrdiff_t>::value);
+    CHECK(std::is_same<std::iterator_traits<MyContainer<int>::MiddleOutOrder>::reference, const int&>::value);
+
+    MyContainer<int> c; // Create an instance of MyContainer with int type
+
+    // Add elements to the container
+    c.add(7);
+    c.add(15);
+    c.add(6);
+    c.add(1);
+    c.add(2);
+
+    // Original order: [7, 15, 6, 1, 2]
+
+    SUBCASE("Distance, advance and subscript") {
+        auto begin = c.begin_ascending_order();
+        auto end = c.end_ascending_order();
+        CHECK(std::distance(begin, end) == 5);
+        CHECK(end - begin == 5);
+        CHECK(begin[2] == 6);
+        CHECK(*(begin + 4) == 15);
+        CHECK(*(end - 1) == 15);
+
+        auto it = begin;
+        std::advance(it, 3);
+        CHECK(*it == 7);
+        CHECK(begin < it);
+        CHECK(it >= begin);
+        --it;
+        CHECK(*it == 6);
+    }
+
+    SUBCASE("Binary search on the ascending view") {
+        auto found = std::lower_bound(c.begin_ascending_order(), c.end_ascending_order(), 6);
+        CHECK(*found == 6);
+        CHECK(found - c.begin_ascending_order() == 2);
+        CHECK(std::binary_search(c.begin_ascending_order(), c.end_ascending_order(), 15));
+        CHECK_FALSE(std::binary_search(c.begin_ascending_order(), c.end_ascending_order(), 8));
+    }
+
+    SUBCASE("Reverse iterators and copying out") {
+        std::vector<int> result(std::make_reverse_iterator(c.end_middle_out_order()),
+                                std::make_reverse_iterator(c.begin_middle_out_order()));
+        CHECK(result == std::vector<int>({2, 7, 1, 15, 6})); // Middle-out order walked backwards
+
+        std::vector<int> descending(c.begin_descending_order(), c.end_descending_order());
+        CHECK(descending == std::vector<int>({15, 7, 6, 2, 1}));
+        CHECK(std::is_sorted(c.begin_ascending_order(), c.end_ascending_order()));
+
+        std::vector<int> side_cross(std::make_reverse_iterator(c.end_side_cross_order()),
+                                    std::make_reverse_iterator(c.begin_side_cross_order()));
+        CHECK(side_cross == std::vector<int>({6, 7, 2, 15, 1})); // Side-cross order walked backwards
+    }
+}
+
+TEST_CASE("Parallel sort gives the same order as the serial sort") {
+    std::mt19937 rng(42); // Fixed seed for reproducible data
+    std::uniform_int_distribution<int> keys(0, 99); // Few distinct keys, so there are many ties
+
+    MyContainer<Tagged> serial; // Sorted on one thread
+    MyContainer<Tagged> parallel; // Sorted on several threads
+    for (int i = 0; i < 5000; ++i) {
+        Tagged value{keys(rng), i};
+        serial.add(value);
+        parallel.add(value);
+    }
+
+    parallel.set_sort_threads(3); // Uneven split on purpose
+    parallel.set_parallel_sort_threshold(1); // Always take the parallel path
+
+    std::vector<int> serial_tags, parallel_tags; // Collect the tags in visiting order
+    for (auto it = serial.begin_ascending_order(); it != serial.end_ascending_order(); ++it) {
+        serial_tags.push_back(it->tag);
+    }
+    for (auto it = parallel.begin_ascending_order(); it != parallel.end_ascending_order(); ++it) {
+        parallel_tags.push_back(it->tag);
+    }
+
+    CHECK(parallel_tags == serial_tags); // Same permutation, including the order of equal keys
+    CHECK(std::is_sorted(parallel.begin_ascending_order(), parallel.end_ascending_order()));
+
+    MyContainer<std::string> words; // Parallel path with more threads than elements
+    words.set_sort_threads(8);
+    words.set_parallel_sort_threshold(1);
+    words.add("pear");
+    words.add("apple");
+    words.add("fig");
+
+    std::vector<std::string> result(words.begin_ascending_order(), words.end_ascending_order());
+    CHECK(result == std::vector<std::string>({"apple", "fig", "pear"}));
+}
+
+TEST_CASE("Radix sort path for integral and floating point types") {
+    std::mt19937 rng(7); // Fixed seed for reproducible data
+    // Radix sort is forced, since the automatic strategy picks it only for large containers
+
+    SUBCASE("int including extreme values") {
+        MyContainer<int> c; // Create an instance of MyContainer with int type
+        c.set_sort_strategy(SortStrategy::radix);
+        std::vector<int> expected({std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), 0, -1, 1});
+        std::uniform_int_distribution<int> values(-100000, 100000);
+        for (int i = 0; i < 1000; ++i) {
+            expected.push_back(values(rng));
+        }
+        c.append_range(expected.begin(), expected.end());
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<int> result(c.begin_ascending_order(), c.end_ascending_order());
+        CHECK(result == expected);
+    }
+
+    SUBCASE("unsigned and narrow integer types") {
+        MyContainer<unsigned long long> big; // Create an instance of MyContainer with unsigned long long type
+        big.set_sort_strategy(SortStrategy::radix);
+        big.add(1ULL << 63);
+        big.add(5);
+        big.add(0);
+        CHECK(std::vector<unsigned long long>(big.begin_ascending_order(), big.end_ascending_order()) ==
+              std::vector<unsigned long long>({0, 5, 1ULL << 63}));
+
+        MyContainer<signed char> small; // Create an instance of MyContainer with signed char type
+        small.set_sort_strategy(SortStrategy::radix);
+        small.add(100);
+        small.add(-128);
+        small.add(-1);
+        CHECK(std::vector<signed char>(small.begin_ascending_order(), small.end_ascending_order()) ==
+              std::vector<signed char>({-128, -1, 100}));
+    }
+
+    SUBCASE("double including infinities and signed zeros") {
+        MyContainer<double> c; // Create an instance of MyContainer with double type
+        c.set_sort_strategy(SortStrategy::radix);
+        std::vector<double> expected({std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                                      1e-300, -1e-300, std::numeric_limits<double>::lowest()});
+        std::uniform_real_distribution<double> values(-1e6, 1e6);
+        for (int i = 0; i < 1000; ++i) {
+            expected.push_back(values(rng));
+        }
+        c.append_range(expected.begin(), expected.end());
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<double> result(c.begin_ascending_order(), c.end_ascending_order());
+        CHECK(result == expected);
+
+        MyContainer<float> zeros; // -0.0 and +0.0 are equal, so they keep their insertion order
+        zeros.set_sort_strategy(SortStrategy::radix);
+        zeros.add(0.0f);
+        zeros.add(-0.0f);
+        zeros.add(-1.5f);
+        auto it = zeros.begin_ascending_order();
+        CHECK(*it == -1.5f);
+        CHECK_FALSE(std::signbit(*++it)); // +0.0 was added first
+        CHECK(std::signbit(*++it));
+    }
+
+    SUBCASE("parallel passes give the serial permutation") {
+        std::vector<long long> values;
+        std::uniform_int_distribution<long long> keys(-300, 300); // Many ties, and high bytes that differ in sign only
+        for (int i = 0; i < 5000; ++i) {
+            values.push_back(keys(rng) * (i % 3 == 0 ? 1000000000LL : 1));
+        }
+
+        // Indices of an ascending traversal (ties must stay in insertion order)
+        auto permutation = [&values](size_t threads, SortStrategy strategy) {
+            MyContainer<long long> c;
+            c.append_range(values.begin(), values.end());
+            c.set_sort_strategy(strategy);
+            c.set_sort_threads(threads);
+            c.set_parallel_sort_threshold(1);
+
+            std::vector<std::ptrdiff_t> indices;
+            for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it) {
+                indices.push_back(&*it - &*c.begin_order());
+            }
+            return indices;
+        };
+
+        std::vector<std::ptrdiff_t> expected = permutation(1, SortStrategy::indirect);
+        for (size_t threads : {size_t(1), size_t(2), size_t(3), size_t(8)}) {
+            CAPTURE(threads);
+            CHECK(permutation(threads, SortStrategy::radix) == expected);
+            CHECK(permutation(threads, SortStrategy::automatic) == expected); // Radix too, at this size
+        }
+    }
+}
+
+TEST_CASE("Activity counters") {
+    MyContainer<int> c; // Create an instance of MyContainer with int type
+
+    // Add elements to the container
+    c.add(5);
+    c.add(1);
+    c.add(5);
+    c.add(3);
+    c.emplace(2);
+
+    // Original order: [5, 1, 5, 3, 2]
+
+    CHECK(c.stats().add_calls == 5);
+
+    c.remove(5); // Removes index 0 and 2, survivors 1, 3 and 2 are moved to the front
+    CHECK(c.stats().remove_calls == 1);
+    CHECK(c.stats().elements_shifted == 3);
+
+    // Two traversals of the unchanged container sort once
+    for (int round = 0; round < 2; ++round) {
+        for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it) {}
+    }
+    for (auto it = c.begin_descending_order(); it != c.end_descending_order(); ++it) {}
+    CHECK(c.stats().sorts_performed == 1);
+    CHECK(c.stats().allocations_for(IteratorKind::ascending) == 1);
+    CHECK(c.stats().bytes_for(IteratorKind::ascending) == 3 * sizeof(std::uint32_t)); // 32-bit indices by default
+    CHECK(c.stats().allocations_for(IteratorKind::descending) == 0);
+
+    // Index-free iterators never allocate
+    for (auto it = c.begin_middle_out_order(); it != c.end_middle_out_order(); ++it) {}
+    CHECK(c.stats().allocations_for(IteratorKind::middle_out) == 0);
+
+    std::string json = c.stats().to_json();
+    CHECK(json.find("\"add_calls\":5") != std::string::npos);
+    CHECK(json.find("\"index_allocations\":{\"ascending\":1,") != std::string::npos);
+    CHECK(json.front() == '{');
+    CHECK(json.back() == '}');
+
+    c.reset_stats();
+    CHECK(c.stats().add_calls == 0);
+}
+
+TEST_CASE("MyContainer with an arena allocator") {
+    MonotonicArena arena(1024); // Small blocks to exercise growing
+    MyContainer<int, ArenaAllocator<int>> c{ArenaAllocator<int>(arena)}; // Elements and index buffers live in the arena
+
+    // Add elements to the container
+    for (int i = 0; i < 100; ++i) {
+        c.add((i * 37) % 101);
+    }
+    size_t used_by_elements = arena.bytes_allocated();
+    CHECK(used_by_elements >= 100 * sizeof(int));
+    CHECK(c.get_allocator().arena() == &arena);
+
+    std::vector<int> result(c.begin_ascending_order(), c.end_ascending_order());
+    CHECK(std::is_sorted(result.begin(), result.end()));
+    CHECK(result.size() == 100);
+    CHECK(arena.bytes_allocated() >= used_by_elements + 100 * sizeof(std::uint32_t)); // Sorted permutation came from the arena
+
+    std::vector<int> side_cross(c.begin_side_cross_order(), c.end_side_cross_order());
+    CHECK(side_cross.front() == result.front());
+    CHECK(side_cross[1] == result.back());
+
+    c.remove(0);
+    std::stringstream out;
+    out << c; // Output operator works with any allocator
+    CHECK(out.str().front() == '[');
+
+    // Sort scratch (radix and decorated pairs, radix histograms) comes from the arena too
+    for (SortStrategy strategy : {SortStrategy::radix, SortStrategy::decorated}) {
+        MonotonicArena scratch_arena(1 << 20); // One block holds everything, so the arena itself never grows here
+        MyContainer<int, ArenaAllocator<int>> big{ArenaAllocator<int>(scratch_arena)};
+        for (int i = 0; i < 5000; ++i) {
+            big.add((i * 7919) % 5003);
+        }
+        big.set_sort_strategy(strategy);
+
+        size_t before = global_allocations;
+        size_t arena_before = scratch_arena.bytes_allocated();
+        int smallest = *big.begin_ascending_order();
+        size_t after = global_allocations;
+        CHECK(smallest == 0);
+        CHECK(after == before);
+        CHECK(scratch_arena.bytes_allocated() >= arena_before + 5000 * (sizeof(int) + sizeof(std::uint32_t))); // Pairs included
+    }
+}
+
+TEST_CASE("MonotonicArena alignment and release") {
+    MonotonicArena arena(64); // Tiny blocks, most requests need a new block
+
+    void* small = arena.allocate(3, 1);
+    void* aligned = arena.allocate(24, 16);
+    void* large = arena.allocate(1000, 8); // Bigger than a block
+
+    CHECK(small != nullptr);
+    CHECK(reinterpret_cast<std::uintptr_t>(aligned) % 16 == 0);
+    CHECK(reinterpret_cast<std::uintptr_t>(large) % 8 == 0);
+    CHECK(arena.bytes_allocated() >= 1027);
+
+    arena.release();
+    CHECK(arena.bytes_allocated() == 0);
+}
+
+TEST_CASE("Index buffers are recycled between traversals") {
+    MyContainer<int> c; // Create an instance of MyContainer with int type
+
+    // Add elements to the container
+    c.add(4);
+    c.add(9);
+    c.add(1);
+    c.add(7);
+
+    // Repeated side-cross traversals only read the shared permutation
+    for (int round = 0; round < 5; ++round) {
+        std::vector<int> result(c.begin_side_cross_order(), c.end_side_cross_order());
+        CHECK(result == std::vector<int>({1, 9, 4, 7}));
+    }
+    CHECK(c.stats().allocations_for(IteratorKind::side_cross) == 1); // The permutation, built once
+
+    // Rebuilding after a removal reuses the stale permutation's buffer (it is large enough)
+    c.remove(9);
+    std::vector<int> result(c.begin_ascending_order(), c.end_ascending_order());
+    CHECK(result == std::vector<int>({1, 4, 7}));
+    CHECK(c.stats().allocations_for(IteratorKind::ascending) == 0);
+    CHECK(c.stats().sorts_performed == 2);
+
+    // A buffer still held by a live iterator is never reused
+    auto held = c.begin_ascending_order(); // Holds the permutation of [4, 1, 7], which is [1, 0, 2]
+    c.remove(1);
+    std::vector<int> after(c.begin_ascending_order(), c.end_ascending_order());
+    CHECK(after == std::vector<int>({4, 7}));
+    CHECK(*held == 7); // Still index 1 (data is now [4, 7]); a reused buffer would start at index 0
+}
+
+TEST_CASE("Index width of the permutation buffers") {
+    SUBCASE("16-bit indices") {
+        MyContainer<int, std::allocator<int>, std::uint16_t> c; // Tiny container with 16-bit indices
+        CHECK(c.max_size() == 65535);
+
+        // Add elements to the container
+        std::vector<int> values(65535);
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = static_cast<int>((i * 7919) % 65535);
+        }
+        c.append_range(values.begin(), values.end());
+
+        std::sort(values.begin(), values.end());
+        CHECK(std::vector<int>(c.begin_ascending_order(), c.end_ascending_order()) == values);
+        CHECK(c.stats().bytes_for(IteratorKind::ascending) == 65535 * sizeof(std::uint16_t));
+
+        CHECK_THROWS_AS(c.add(1), std::length_error); // No index left for another element
+        CHECK_THROWS_AS(c.emplace(1), std::length_error);
+        CHECK_THROWS_AS(c.append_range(values.begin(), values.begin() + 1), std::length_error);
+        CHECK(c.size() == 65535); // Nothing was added
+
+        c.remove(0); // Frees one slot
+        c.add(-1);
+        CHECK(*c.begin_ascending_order() == -1);
+    }
+
+    SUBCASE("64-bit indices") {
+        MyContainer<std::string, std::allocator<std::string>, size_t> c; // Full-width indices
+        c.add("b");
+        c.add("a");
+        CHECK(*c.begin_ascending_order() == "a");
+        CHECK(*c.begin_descending_order() == "b");
+    }
+}
+
+TEST_CASE("Sort strategies give identical permutations") {
+    std::mt19937 rng(3); // Fixed seed for reproducible data
+    std::uniform_int_distribution<int> keys(0, 49); // Many ties
+
+    std::vector<Tagged> values;
+    for (int i = 0; i < 3000; ++i) {
+        values.push_back(Tagged{keys(rng), i});
+    }
+
+    // Collect the tags of an ascending traversal with a given strategy (and thread count)
+    auto tags_with = [&values](SortStrategy strategy, size_t threads) {
+        MyContainer<Tagged> c;
+        c.append_range(values.begin(), values.end());
+        c.set_sort_strategy(strategy);
+        c.set_sort_threads(threads);
+        c.set_parallel_sort_threshold(1);
+
+        std::vector<int> tags;
+        for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it) {
+            tags.push_back(it->tag);
+        }
+        return tags;
+    };
+
+    std::vector<int> indirect = tags_with(SortStrategy::indirect, 1);
+    CHECK(tags_with(SortStrategy::decorated, 1) == indirect);
+    CHECK(tags_with(SortStrategy::decorated, 4) == indirect);
+    CHECK(tags_with(SortStrategy::automatic, 1) == indirect);
+
+    // Doubles: radix (the automatic choice) and decorated agree with indirect
+    MyContainer<double> numbers;
+    std::uniform_real_distribution<double> reals(-10, 10);
+    for (int i = 0; i < 2000; ++i) {
+        numbers.add(std::round(reals(rng)));
+    }
+    std::vector<double> expected(numbers.begin_ascending_order(), numbers.end_ascending_order());
+    for (SortStrategy strategy : {SortStrategy::indirect, SortStrategy::decorated}) {
+        numbers.set_sort_strategy(strategy);
+        numbers.add(0.5); // Invalidate the cached permutation
+        numbers.remove(0.5);
+        CHECK(std::vector<double>(numbers.begin_ascending_order(), numbers.end_ascending_order()) == expected);
+    }
+
+    MyContainer<std::string> words;
+    CHECK_THROWS_AS(words.set_sort_strategy(SortStrategy::radix), std::invalid_argument);
+    words.set_sort_strategy(SortStrategy::decorated); // Allowed for any copyable type
+}
+
+TEST_CASE("Sorted permutation is extended incrementally after adds") {
+    std::mt19937 rng(11); // Fixed seed for reproducible data
+    std::uniform_int_distribution<int> keys(0, 20); // Many ties
+
+    MyContainer<Tagged> c; // Create an instance of MyContainer with Tagged type
+    std::vector<Tagged> all; // Same elements, sorted from scratch for comparison
+
+    int tag = 0;
+    for (int round = 0; round < 5; ++round) {
+        // Add a batch of new elements
+        for (int i = 0; i < 50; ++i) {
+            Tagged value{keys(rng), tag++};
+            c.add(value);
+            all.push_back(value);
+        }
+
+        // Ascending traversal merges the new batch into the existing permutation
+        std::vector<int> tags;
+        for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it) {
+            tags.push_back(it->tag);
+        }
+
+        std::vector<Tagged> expected(all);
+        std::stable_sort(expected.begin(), expected.end()); // Equal keys in insertion order
+        std::vector<int> expected_tags;
+        for (const Tagged& value : expected) {
+            expected_tags.push_back(value.tag);
+        }
+
+        CHECK(tags == expected_tags);
+    }
+
+    CHECK(c.stats().sorts_performed == 1); // Only the first traversal sorted everything
+    CHECK(c.stats().merges_performed == 4);
+
+    c.remove(Tagged{0, 0}); // Removing shifts indices, so the next traversal sorts from scratch
+    CHECK(std::is_sorted(c.begin_ascending_order(), c.end_ascending_order()));
+    CHECK(c.stats().sorts_performed == 2);
+}
+
+TEST_CASE("Order statistics") {
+    MyContainer<int> c; // Create an instance of MyContainer with int type
+
+    // Add elements to the container
+    std::vector<int> values({50, 10, 40, 20, 30, 20, 90, 70, 60, 80});
+    c.append_range(values.begin(), values.end());
+
+    // Sorted: [10, 20, 20, 30, 40, 50, 60, 70, 80, 90]
+
+    // Run the same checks without and with an up-to-date sorted permutation
+    for (int pass = 0; pass < 2; ++pass) {
+        CAPTURE(pass);
+        if (pass == 1) {
+            c.begin_ascending_order(); // Builds the sorted permutation
+        }
+
+        CHECK(c.kth_smallest(0) == 10);
+        CHECK(c.kth_smallest(2) == 20);
+        CHECK(c.kth_smallest(9) == 90);
+        CHECK_THROWS_AS(c.kth_smallest(10), std::out_of_range);
+
+        CHECK(c.rank(10) == 0);
+        CHECK(c.rank(20) == 1);
+        CHECK(c.rank(25) == 3);
+        CHECK(c.rank(100) == 10);
+
+        CHECK(c.count_in_range(20, 50) == 5);
+        CHECK(c.count_in_range(21, 29) == 0);
+        CHECK(c.count_in_range(0, 1000) == 10);
+        CHECK(c.count_in_range(50, 20) == 0);
+
+        CHECK(c.percentile(0) == 10);
+        CHECK(c.percentile(50) == 40);
+        CHECK(c.percentile(90) == 80);
+        CHECK(c.percentile(99) == 90);
+        CHECK(c.percentile(100) == 90);
+        CHECK_THROWS_AS(c.percentile(101), std::out_of_range);
+    }
+
+    SUBCASE("percentile at exact ranks") {
+        MyContainer<int> hundred; // 1..100, so the p-th percentile is p
+        for (int i = 1; i <= 100; ++i) {
+            hundred.add(i);
+        }
+        CHECK(hundred.percentile(7) == 7);
+        CHECK(hundred.percentile(14) == 14);
+        CHECK(hundred.percentile(28) == 28);
+        CHECK(hundred.percentile(55) == 55);
+        CHECK(hundred.percentile(56) == 56);
+        for (int p = 1; p <= 100; ++p) {
+            CAPTURE(p);
+            CHECK(hundred.percentile(p) == p);
+        }
+        CHECK(hundred.percentile(6.5) == 7); // Between ranks: round up
+    }
+
+    CHECK(c.stats().sorts_performed == 1); // Only the explicit traversal sorted
+
+    MyContainer<double> empty;
+    CHECK_THROWS_AS(empty.percentile(50), std::out_of_range);
+    CHECK(empty.rank(1.0) == 0);
+}
+
+TEST_CASE("Top-k views of ascending and descending order") {
+    MyContainer<Tagged> c; // Create an instance of MyContainer with Tagged type
+    std::mt19937 rng(5); // Fixed seed for reproducible data
+    std::uniform_int_distribution<int> keys(0, 30); // Many ties
+    for (int i = 0; i < 300; ++i) {
+        c.add(Tagged{keys(rng), i});
+    }
+
+    // Tags visited between two iterators
+    auto tags = [](auto first, auto last) {
+        std::vector<int> result;
+        for (; first != last; ++first) {
+            result.push_back(first->tag);
+        }
+        return result;
+    };
+
+    for (size_t k : {size_t(0), size_t(1), size_t(10), size_t(299), size_t(300), size_t(1000)}) {
+        CAPTURE(k);
+
+        // Without a sorted permutation (bounded heap)
+        std::vector<int> smallest = tags(c.begin_ascending_order(k), c.end_ascending_order(k));
+        std::vector<int> largest = tags(c.begin_descending_order(k), c.end_descending_order(k));
+
+        // Walking backwards from the end iterators selects the same k elements, without a full sort either
+        std::vector<int> smallest_reversed = tags(std::make_reverse_iterator(c.end_ascending_order(k)),
+                                                  std::make_reverse_iterator(c.begin_ascending_order(k)));
+        std::vector<int> largest_reversed = tags(std::make_reverse_iterator(c.end_descending_order(k)),
+                                                 std::make_reverse_iterator(c.begin_descending_order(k)));
+        CHECK(std::equal(smallest_reversed.begin(), smallest_reversed.end(), smallest.rbegin(), smallest.rend()));
+        CHECK(std::equal(largest_reversed.begin(), largest_reversed.end(), largest.rbegin(), largest.rend()));
+        if (k > 0) {
+            CHECK(c.end_ascending_order(k)[-1].tag == smallest.back());
+            CHECK((--c.end_descending_order(k))->tag == largest.back());
+        }
+        CHECK(c.stats().sorts_performed == 0);
+
+        // Same elements, in the same order, as the first k positions of the full traversals
+        std::vector<int> full_ascending = tags(c.begin_ascending_order(), c.end_ascending_order());
+        std::vector<int> full_descending = tags(c.begin_descending_order(), c.end_descending_order());
+        size_t expected_size = std::min<size_t>(k, 300);
+        CHECK(smallest == std::vector<int>(full_ascending.begin(), full_ascending.begin() + expected_size));
+        CHECK(largest == std::vector<int>(full_descending.begin(), full_descending.begin() + expected_size));
+
+        // With an up-to-date sorted permutation (reused directly)
+        CHECK(tags(c.begin_ascending_order(k), c.end_ascending_order(k)) == smallest);
+        CHECK(tags(c.begin_descending_order(k), c.end_descending_order(k)) == largest);
+
+        c.add(Tagged{100, -1}); // Invalidate the permutation for the next round
+        c.remove(Tagged{100, -1});
+        c.reset_stats();
+    }
+}
+
+TEST_CASE("Lazy ascending and descending iterators sort incrementally") {
+    MyContainer<Tagged> c; // Create an instance of MyContainer with Tagged type
+    std::mt19937 rng(11); // Fixed seed for reproducible data
+    std::uniform_int_distribution<int> keys(0, 50); // Many ties
+    for (int i = 0; i < 1000; ++i) {
+        c.add(Tagged{keys(rng), i});
+    }
+
+    // Tags visited between two iterators
+    auto tags = [](auto first, auto last) {
+        std::vector<int> result;
+        for (; first != last; ++first) {
+            result.push_back(first->tag);
+        }
+        return result;
+    };
+
+    // Reading a few elements does not complete a sort
+    auto lazy = c.begin_lazy_ascending_order();
+    std::vector<int> first_tags;
+    for (int i = 0; i < 5; ++i, ++lazy) {
+        first_tags.push_back(lazy->tag);
+    }
+    auto lazy_descending = c.begin_lazy_descending_order();
+    int largest_tag = lazy_descending->tag;
+    CHECK(c.stats().sorts_performed == 0);
+
+    // Same order as the eager iterators, ties included
+    std::vector<int> ascending = tags(c.begin_ascending_order(), c.end_ascending_order());
+    std::vector<int> descending = tags(c.begin_descending_order(), c.end_descending_order());
+    CHECK(first_tags == std::vector<int>(ascending.begin(), ascending.begin() + 5));
+    CHECK(largest_tag == descending.front());
+
+    c.add(Tagged{100, -1}); // Invalidate the cached permutation (key 100 is unique)
+    c.remove(Tagged{100, -1});
+    c.reset_stats();
+
+    CHECK(tags(c.begin_lazy_ascending_order(), c.end_lazy_ascending_order()) == ascending);
+    CHECK(c.stats().sorts_performed == 1); // The finished lazy sort became the cached permutation
+    CHECK(tags(c.begin_ascending_order(), c.end_ascending_order()) == ascending);
+    CHECK(c.stats().sorts_performed == 1);
+
+    c.add(Tagged{100, -1});
+    c.remove(Tagged{100, -1});
+    CHECK(tags(c.begin_lazy_descending_order(), c.end_lazy_descending_order()) == descending);
+
+    // Copies share the progress, random access and decrementing the end iterator work
+    c.add(Tagged{100, -1});
+    c.remove(Tagged{100, -1});
+    auto begin = c.begin_lazy_ascending_order();
+    auto copy = begin;
+    CHECK(copy[500].tag == ascending[500]);
+    CHECK(begin[499].tag == ascending[499]);
+    CHECK((c.end_lazy_descending_order() - 1)->tag == descending.back());
+    CHECK(std::is_sorted(c.begin_lazy_ascending_order(), c.end_lazy_ascending_order()));
+
+    MyContainer<int> empty;
+    CHECK(empty.begin_lazy_ascending_order() == empty.end_lazy_ascending_order());
+    CHECK(empty.begin_lazy_descending_order() == empty.end_lazy_descending_order());
+}
+
+TEST_CASE("Side-cross order reads the shared ascending permutation") {
+    MyContainer<int> c; // Create an instance of MyContainer with int type
+    for (int value : {5, 3, 9, 1, 7, 3, 8}) {
+        c.add(value);
+    }
+
+    std::vector<int> ascending(c.begin_ascending_order(), c.end_ascending_order());
+    c.reset_stats();
+
+    // Built from the cached permutation: no sort and no index buffer
+    auto it = c.begin_side_cross_order();
+    CHECK(c.stats().sorts_performed == 0);
+    CHECK(c.stats().allocations_for(IteratorKind::side_cross) == 0);
+
+    // Position p reads asc[p / 2] (even p) or asc[n - 1 - p / 2] (odd p)
+    size_t n = ascending.size();
+    for (size_t p = 0; p < n; ++p) {
+        CHECK(it[static_cast<std::ptrdiff_t>(p)] == (p % 2 == 0 ? ascending[p / 2] : ascending[n - 1 - p / 2]));
+    }
+    CHECK(std::vector<int>(it, c.end_side_cross_order()) == std::vector<int>({1, 9, 3, 8, 3, 7, 5}));
+}
+
+TEST_CASE("Descending order is the reverse of ascending order, ties included") {
+    MyContainer<Tagged> c; // Create an instance of MyContainer with Tagged type
+
+    // Keys with duplicates, tags record the insertion order
+    int keys[] = {2, 1, 2, 3, 1, 2};
+    for (int i = 0; i < 6; ++i) {
+        c.add(Tagged{keys[i], i});
+    }
+
+    std::vector<int> ascending;
+    for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it) {
+        ascending.push_back(it->tag);
+    }
+    CHECK(ascending == std::vector<int>({1, 4, 0, 2, 5, 3})); // Equal keys in insertion order
+
+    std::vector<int> descending;
+    for (auto it = c.begin_descending_order(); it != c.end_descending_order(); ++it) {
+        descending.push_back(it->tag);
+    }
+    CHECK(descending == std::vector<int>({3, 5, 2, 0, 4, 1})); // Equal keys in reverse insertion order
+    CHECK(std::equal(descending.begin(), descending.end(), ascending.rbegin()));
+
+    // One sort served both directions
+    CHECK(c.stats().sorts_performed == 1);
+}
+
+TEST_CASE("Copying iterators does not allocate") {
+    MonotonicArena arena; // Every allocation of the container, index buffers included, is visible here
+    MyContainer<int, ArenaAllocator<int>> c{ArenaAllocator<int>(arena)};
+    for (int i = 0; i < 10000; ++i) {
+        c.add((i * 7919) % 10007);
+    }
+
+    // Build the shared permutation once
+    CHECK(*c.begin_ascending_order() == 0);
+    size_t used = arena.bytes_allocated();
+    std::vector<int> out(c.size());
+
+    // Post-increment copies the iterator on every step
+    long long sum = 0;
+    for (auto it = c.begin_descending_order(); it != c.end_descending_order();) {
+        sum += *it++;
+    }
+    for (auto it = c.begin_side_cross_order(); it != c.end_side_cross_order();) {
+        sum -= *it++;
+    }
+    CHECK(sum == 0);
+
+    // Algorithms that copy iterators freely
+    auto found = std::find_if(c.begin_ascending_order(), c.end_ascending_order(), [](int value) { return value > 5000; });
+    CHECK(*found == 5001);
+    std::copy(c.begin_ascending_order(), c.end_ascending_order(), out.begin());
+    CHECK(std::is_sorted(out.begin(), out.end()));
+    std::copy(c.begin_middle_out_order(), c.end_middle_out_order(), out.begin());
+    auto copy = c.begin_descending_order();
+    auto another = copy;
+    CHECK(*another == *copy);
+
+    CHECK(arena.bytes_allocated() == used);
+    CHECK(c.stats().sorts_performed == 1);
+}
+
+TEST_CASE("for_each_chunk hands out contiguous chunks in every order") {
+    MyContainer<int> c; // Create an instance of MyContainer with int type
+    for (int i = 0; i < 23; ++i) {
+        c.add((i * 11) % 23 - 7);
+    }
+
+    // Concatenation of the chunks of one order
+    auto chunks = [&c](IteratorKind order, size_t chunk_size) {
+        std::vector<int> values;
+        std::vector<size_t> sizes;
+        c.for_each_chunk(order, chunk_size, [&values, &sizes](const int* chunk, size_t count) {
+            values.insert(values.end(), chunk, chunk + count);
+            sizes.push_back(count);
+        });
+        CHECK(sizes == std::vector<size_t>({5, 5, 5, 5, 3})); // Full chunks, then the remainder
+        return values;
+    };
+
+    CHECK(chunks(IteratorKind::ascending, 5) == std::vector<int>(c.begin_ascending_order(), c.end_ascending_order()));
+    CHECK(chunks(IteratorKind::descending, 5) == std::vector<int>(c.begin_descending_order(), c.end_descending_order()));
+    CHECK(chunks(IteratorKind::side_cross, 5) == std::vector<int>(c.begin_side_cross_order(), c.end_side_cross_order()));
+    CHECK(chunks(IteratorKind::reverse, 5) == std::vector<int>(c.begin_reverse_order(), c.end_reverse_order()));
+    CHECK(chunks(IteratorKind::order, 5) == std::vector<int>(c.begin_order(), c.end_order()));
+    CHECK(chunks(IteratorKind::middle_out, 5) == std::vector<int>(c.begin_middle_out_order(), c.end_middle_out_order()));
+
+    // Insertion order reads the container's storage directly
+    const int* first = nullptr;
+    c.for_each_chunk(IteratorKind::order, 100, [&first](const int* chunk, size_t count) {
+        first = chunk;
+        CHECK(count == 23);
+    });
+    CHECK(first == &*c.begin_order());
+
+    // Typical use: a vectorisable reduction per chunk
+    long long sum = 0;
+    c.for_each_chunk(IteratorKind::ascending, 8, [&sum](const int* chunk, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            sum += chunk[i];
+        }
+    });
+    CHECK(sum == std::accumulate(c.begin_order(), c.end_order(), 0LL));
+
+    CHECK_THROWS_AS(c.for_each_chunk(IteratorKind::order, 0, [](const int*, size_t) {}), std::invalid_argument);
+
+    MyContainer<int> empty;
+    bool called = false;
+    empty.for_each_chunk(IteratorKind::ascending, 4, [&called](const int*, size_t) { called = true; });
+    CHECK_FALSE(called);
+}
+
+TEST_CASE("Prefetching does not change sorted traversals") {
+    MyContainer<int> c; // Create an instance of MyContainer with int type
+    for (int i = 0; i < 50; ++i) {
+        c.add((i * 17) % 50);
+    }
+
+    std::vector<int> ascending(c.begin_ascending_order(), c.end_ascending_order());
+    std::vector<int> descending(c.begin_descending_order(), c.end_descending_order());
+    std::vector<int> side_cross(c.begin_side_cross_order(), c.end_side_cross_order());
+    std::vector<int> top(c.begin_descending_order(5), c.end_descending_order(5));
+
+    // Distances shorter than, equal to and longer than the container
+    for (size_t distance : {size_t(1), size_t(7), size_t(50), size_t(1000)}) {
+        c.set_prefetch_distance(distance);
+        CHECK(std::vector<int>(c.begin_ascending_order(), c.end_ascending_order()) == ascending);
+        CHECK(std::vector<int>(c.begin_descending_order(), c.end_descending_order()) == descending);
+        CHECK(std::vector<int>(c.begin_side_cross_order(), c.end_side_cross_order()) == side_cross);
+        CHECK(std::vector<int>(c.begin_descending_order(5), c.end_descending_order(5)) == top);
+    }
+}
+
+TEST_CASE("Sorted snapshot") {
+    MyContainer<int> c; // Create an instance of MyContainer with int type
+    for (int value : {5, 3, 9, 1, 7, 3}) {
+        c.add(value);
+    }
+
+    auto snapshot = c.sorted_snapshot();
+    CHECK(snapshot.size() == 6);
+    CHECK(std::vector<int>(snapshot.begin(), snapshot.end()) == std::vector<int>({1, 3, 3, 5, 7, 9}));
+    CHECK(std::vector<int>(snapshot.begin_descending_order(), snapshot.end_descending_order()) ==
+          std::vector<int>(c.begin_descending_order(), c.end_descending_order()));
+    CHECK(std::vector<int>(snapshot.begin_side_cross_order(), snapshot.end_side_cross_order()) ==
+          std::vector<int>(c.begin_side_cross_order(), c.end_side_cross_order()));
+    CHECK(snapshot.end_side_cross_order() - snapshot.begin_side_cross_order() == 6);
+    CHECK(*(snapshot.end_side_cross_order() - 1) == 5);
+    CHECK(c.to_sorted_vector() == std::vector<int>({1, 3, 3, 5, 7, 9}));
+
+    // Shared until the next modification
+    auto again = c.sorted_snapshot();
+    CHECK(again.data() == snapshot.data());
+    CHECK(c.stats().sorts_performed == 1);
+
+    // A modification builds a new snapshot and leaves the old one untouched
+    c.remove(9);
+    c.add(0);
+    auto fresh = c.sorted_snapshot();
+    CHECK(fresh.data() != snapshot.data());
+    CHECK(std::vector<int>(fresh.begin(), fresh.end()) == std::vector<int>({0, 1, 3, 3, 5, 7}));
+    CHECK(std::vector<int>(snapshot.begin(), snapshot.end()) == std::vector<int>({1, 3, 3, 5, 7, 9}));
+
+    MyContainer<int> empty;
+    auto none = empty.sorted_snapshot();
+    CHECK(none.empty());
+    CHECK(none.begin_side_cross_order() == none.end_side_cross_order());
+}
+
+TEST_CASE_TEMPLATE("remove on arithmetic types matches std::remove", U, int, unsigned, long long, float, double, short) {
+    std::mt19937 rng(21); // Fixed seed for reproducible data
+
+    // Sizes around the 4 and 8 lane blocks, with few distinct values so every block mixes kept and removed lanes
+    for (size_t n : {size_t(1), size_t(3), size_t(4), size_t(7), size_t(8), size_t(9), size_t(31), size_t(64), size_t(1001)}) {
+        CAPTURE(n);
+        std::vector<U> values(n);
+        for (U& value : values) {
+            value = static_cast<U>(rng() % 4);
+        }
+        U removed = values[rng() % n];
+
+        MyContainer<U> c; // Create an instance of MyContainer with the tested type
+        c.append_range(values.begin(), values.end());
+        c.remove(removed);
+
+        std::vector<U> expected(values);
+        size_t first = static_cast<size_t>(std::find(expected.begin(), expected.end(), removed) - expected.begin());
+        expected.erase(std::remove(expected.begin(), expected.end(), removed), expected.end());
+
+        CHECK(std::vector<U>(c.begin_order(), c.end_order()) == expected);
+        CHECK(c.stats().elements_shifted == expected.size() - first); // Same count as the scalar path
+        CHECK_THROWS_AS(c.remove(removed), std::runtime_error);
+        CHECK(c.size() == expected.size());
+    }
+}
+
+TEST_CASE("remove on floating point types uses IEEE equality") {
+    MyContainer<double> c; // Create an instance of MyContainer with double type
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    for (int i = 0; i < 10; ++i) {
+        c.add(i % 2 == 0 ? 0.0 : -0.0);
+        c.add(nan);
+        c.add(1.5);
+    }
+
+    CHECK_THROWS_AS(c.remove(nan), std::runtime_error); // NaN equals nothing
+    c.remove(-0.0); // Removes +0.0 as well
+    CHECK(c.size() == 20);
+    CHECK(std::count(c.begin_order(), c.end_order(), 1.5) == 10);
+
+    MyContainer<float> f; // Create an instance of MyContainer with float type
+    for (int i = 0; i < 20; ++i) {
+        f.add(i % 3 == 0 ? 2.5f : static_cast<float>(i));
+    }
+    f.remove(2.5f);
+    CHECK(f.size() == 13);
+    CHECK(std::find(f.begin_order(), f.end_order(), 2.5f) == f.end_order());
+}
+
+TEST_CASE("Sorted copies do not outlive the contents they were made from") {
+    long long live = 0; // Bytes currently held through the container's allocator
+    MyContainer<int, LiveBytesAllocator<int>> c{LiveBytesAllocator<int>(&live)};
+    c.reserve(2000);
+    for (int i = 0; i < 1000; ++i) {
+        c.add((i * 37) % 1000);
+    }
+    CHECK(*c.begin_ascending_order() == 0); // Build the permutation
+
+    // to_sorted_vector gathers without caching a second copy
+    long long before = live;
+    {
+        std::vector<int, LiveBytesAllocator<int>> sorted = c.to_sorted_vector();
+        CHECK(std::is_sorted(sorted.begin(), sorted.end()));
+    }
+    CHECK(live == before);
+
+    // A snapshot is kept while the contents match, and dropped by the next add
+    c.sorted_snapshot();
+    CHECK(live >= before + static_cast<long long>(1000 * sizeof(int)));
+    c.add(5);
+    CHECK(live == before);
+
+    // A snapshot still held by the caller stays valid
+    auto snapshot = c.sorted_snapshot();
+    c.remove(5);
+    CHECK(snapshot.size() == 1001);
+    CHECK(snapshot[0] == 0);
+}
+
+TEST_CASE("The index pool does not hoard full-size buffers") {
+    long long live = 0; // Bytes currently held through the container's allocator
+    MyContainer<int, LiveBytesAllocator<int>> c{LiveBytesAllocator<int>(&live)};
+    for (int i = 0; i < 100000; ++i) {
+        c.add((i * 7919) % 100003);
+    }
+    long long permutation_bytes = static_cast<long long>(sizeof(std::uint32_t) * 100000);
+    long long slack = 4096; // Control blocks, merge tails and the small lazy-sort stack
+
+    // Full sort, merge rebuilds, a selection and a lazy sort each borrow a permutation-sized buffer
+    CHECK(*c.begin_ascending_order() == 0);
+    for (int round = 0; round < 3; ++round) {
+        c.add(round);
+        CHECK(*c.begin_ascending_order() == 0);
+    }
+    c.add(-1);
+    CHECK(c.kth_smallest(0) == -1);
+    c.add(-2);
+    CHECK(*c.begin_lazy_ascending_order() == -2);
+
+    // With no iterator alive: the cached permutation plus at most one free buffer of about its size
+    long long elements = static_cast<long long>(c.capacity() * sizeof(int));
+    CHECK(live - elements <= 2 * permutation_bytes + permutation_bytes / 4 + slack);
+
+    // shrink_to_fit releases the free ones, only the cached permutation remains
+    c.shrink_to_fit();
+    elements = static_cast<long long>(c.capacity() * sizeof(int));
+    CHECK(live - elements <= permutation_bytes + slack);
+    CHECK(std::is_sorted(c.begin_ascending_order(), c.end_ascending_order()));
+}
+
+TEST_CASE("Const traversals from several threads") {
+    MyContainer<int> c; // Create an instance of MyContainer with int type
+    for (int i = 0; i < 5000; ++i) {
+        c.add((i * 7919) % 5003);
+    }
+    const MyContainer<int>& shared = c;
+
+    // Each thread builds whatever cache it needs first, in a different order
+    std::vector<std::vector<int>> results(5);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < results.size(); ++t) {
+        threads.emplace_back([&shared, &results, t]() {
+            std::vector<int>& result = results[t];
+            for (size_t round = 0; round < 5; ++round) {
+                switch ((t + round) % 5) {
+                    case 0: result.insert(result.end(), shared.begin_ascending_order(), shared.end_ascending_order()); break;
+                    case 1: result.insert(result.end(), shared.begin_side_cross_order(), shared.end_side_cross_order()); break;
+                    case 2: result.insert(result.end(), shared.begin_lazy_descending_order(), shared.end_lazy_descending_order()); break;
+                    case 3: result.push_back(shared.kth_smallest(7)); result.push_back(shared.sorted_snapshot()[0]); break;
+                    case 4: { // Copy while the others traverse, then traverse the copy
+                        MyContainer<int> copy(shared);
+                        MyContainer<int> assigned; // Assigned too, to cover operator=
+                        assigned = shared;
+                        result.insert(result.end(), copy.begin_ascending_order(), copy.end_ascending_order());
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Every thread saw the same orders, in its own sequence
+    for (std::vector<int>& result : results) {
+        std::sort(result.begin(), result.end());
+        CHECK(result == results[0]);
+    }
+    CHECK(c.stats().sorts_performed == 1); // Built once, shared by all threads
+}